@@ -52,6 +52,16 @@ void GlyphGeometry::edgeColoring(void (*fn)(msdfgen::Shape &, double, unsigned l
 }
 
 void GlyphGeometry::wrapBox(double scale, double range, double miterLimit) {
+    computeBox(box, scale, range, miterLimit);
+}
+
+void GlyphGeometry::measureBox(int &w, int &h, double scale, double range, double miterLimit) const {
+    Box measured;
+    computeBox(measured, scale, range, miterLimit);
+    w = measured.rect.w, h = measured.rect.h;
+}
+
+void GlyphGeometry::computeBox(Box &box, double scale, double range, double miterLimit) const {
     scale *= geometryScale;
     range /= geometryScale;
     box.range = range;
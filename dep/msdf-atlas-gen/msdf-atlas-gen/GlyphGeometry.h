@@ -21,6 +21,8 @@ public:
     void edgeColoring(void (*fn)(msdfgen::Shape &, double, unsigned long long), double angleThreshold, unsigned long long seed);
     /// Computes the dimensions of the glyph's box as well as the transformation for the generator function
     void wrapBox(double scale, double range, double miterLimit);
+    /// Outputs the dimensions wrapBox would give the glyph's box, without modifying it
+    void measureBox(int &w, int &h, double scale, double range, double miterLimit) const;
     /// Sets the glyph's box's position in the atlas
     void placeBox(int x, int y);
     /// Sets the glyph's box's rectangle in the atlas
@@ -67,13 +69,15 @@ private:
     msdfgen::Shape shape;
     msdfgen::Shape::Bounds bounds;
     double advance;
-    struct {
+    struct Box {
         Rectangle rect;
         double range;
         double scale;
         msdfgen::Vector2 translate;
     } box;
 
+    void computeBox(Box &box, double scale, double range, double miterLimit) const;
+
 };
 
 }
@@ -29,6 +29,8 @@ public:
     void setAttributes(const GeneratorAttributes &attributes);
     /// Sets the number of threads to be run by generate
     void setThreadCount(int threadCount);
+    /// Makes generate run on an external thread pool instead of its own threads, or stop if null
+    void setExecutor(WorkloadExecutor *executor);
     /// Allows access to the underlying AtlasStorage
     const AtlasStorage & atlasStorage() const;
     /// Returns the layout of the contained glyphs as a list of GlyphBoxes
@@ -41,6 +43,7 @@ private:
     std::vector<byte> errorCorrectionBuffer;
     GeneratorAttributes attributes;
     int threadCount;
+    WorkloadExecutor *executor;
 
 };
 
@@ -6,35 +6,39 @@
 namespace msdf_atlas {
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
-ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator() : threadCount(1) { }
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator() : threadCount(1), executor(NULL) { }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
-ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height) : storage(width, height), threadCount(1) { }
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height) : storage(width, height), threadCount(1), executor(NULL) { }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 template <typename... ARGS>
-ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height, ARGS... storageArgs) : storage(width, height, storageArgs...), threadCount(1) { }
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height, ARGS... storageArgs) : storage(width, height, storageArgs...), threadCount(1), executor(NULL) { }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generate(const GlyphGeometry *glyphs, int count) {
     int maxBoxArea = 0;
+    // Estimated cost of each glyph, the generator visits every pixel for every edge
+    std::vector<double> glyphCosts(count);
     for (int i = 0; i < count; ++i) {
         GlyphBox box = glyphs[i];
         maxBoxArea = std::max(maxBoxArea, box.rect.w*box.rect.h);
+        glyphCosts[i] = glyphs[i].isWhitespace() ? 0. : double(box.rect.w*box.rect.h)*glyphs[i].getShape().edgeCount();
         layout.push_back((GlyphBox &&) box);
     }
+    int workerCount = executor ? std::max(executor->threadCount(), 1) : threadCount;
     int threadBufferSize = N*maxBoxArea;
-    if (threadCount*threadBufferSize > (int) glyphBuffer.size())
-        glyphBuffer.resize(threadCount*threadBufferSize);
-    if (threadCount*maxBoxArea > (int) errorCorrectionBuffer.size())
-        errorCorrectionBuffer.resize(threadCount*maxBoxArea);
-    std::vector<GeneratorAttributes> threadAttributes(threadCount);
-    for (int i = 0; i < threadCount; ++i) {
+    if (workerCount*threadBufferSize > (int) glyphBuffer.size())
+        glyphBuffer.resize(workerCount*threadBufferSize);
+    if (workerCount*maxBoxArea > (int) errorCorrectionBuffer.size())
+        errorCorrectionBuffer.resize(workerCount*maxBoxArea);
+    std::vector<GeneratorAttributes> threadAttributes(workerCount);
+    for (int i = 0; i < workerCount; ++i) {
         threadAttributes[i] = attributes;
         threadAttributes[i].config.errorCorrection.buffer = errorCorrectionBuffer.data()+i*maxBoxArea;
     }
 
-    Workload([this, glyphs, &threadAttributes, threadBufferSize](int i, int threadNo) -> bool {
+    Workload workload([this, glyphs, &threadAttributes, threadBufferSize](int i, int threadNo) -> bool {
         const GlyphGeometry &glyph = glyphs[i];
         if (!glyph.isWhitespace()) {
             int l, b, w, h;
@@ -44,7 +48,11 @@ void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generate(const GlyphGe
             storage.put(l, b, msdfgen::BitmapConstRef<T, N>(glyphBitmap));
         }
         return true;
-    }, count).finish(threadCount);
+    }, count, glyphCosts);
+    if (executor)
+        workload.finish(*executor);
+    else
+        workload.finish(threadCount);
 }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
@@ -73,6 +81,11 @@ void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setThreadCount(int thr
     this->threadCount = threadCount;
 }
 
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setExecutor(WorkloadExecutor *executor) {
+    this->executor = executor;
+}
+
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 const AtlasStorage & ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::atlasStorage() const {
     return storage;
@@ -21,6 +21,11 @@ int RectanglePacker::rateFit(int w, int h, int sw, int sh) {
 RectanglePacker::RectanglePacker() : RectanglePacker(0, 0) { }
 
 RectanglePacker::RectanglePacker(int width, int height) {
+    reset(width, height);
+}
+
+void RectanglePacker::reset(int width, int height) {
+    spaces.clear();
     if (width > 0 && height > 0)
         spaces.push_back(Rectangle { 0, 0, width, height });
 }
@@ -55,7 +60,7 @@ void RectanglePacker::splitSpace(int index, int w, int h) {
 }
 
 int RectanglePacker::pack(Rectangle *rectangles, int count) {
-    std::vector<int> remainingRects(count);
+    remainingRects.resize(count);
     for (int i = 0; i < count; ++i)
         remainingRects[i] = i;
     while (!remainingRects.empty()) {
@@ -94,7 +99,7 @@ int RectanglePacker::pack(Rectangle *rectangles, int count) {
 }
 
 int RectanglePacker::pack(OrientedRectangle *rectangles, int count) {
-    std::vector<int> remainingRects(count);
+    remainingRects.resize(count);
     for (int i = 0; i < count; ++i)
         remainingRects[i] = i;
     while (!remainingRects.empty()) {
@@ -12,6 +12,8 @@ class RectanglePacker {
 public:
     RectanglePacker();
     RectanglePacker(int width, int height);
+    /// Empties the packing area and sets its dimensions, keeping allocated memory
+    void reset(int width, int height);
     /// Expands the packing area - both width and height must be greater or equal to the previous value
     void expand(int width, int height);
     /// Packs the rectangle array, returns how many didn't fit (0 on success)
@@ -20,6 +22,7 @@ public:
 
 private:
     std::vector<Rectangle> spaces;
+    std::vector<int> remainingRects;
 
     static int rateFit(int w, int h, int sw, int sh);
 
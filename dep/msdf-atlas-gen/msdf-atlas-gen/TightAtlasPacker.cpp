@@ -1,8 +1,8 @@
 
 #include "TightAtlasPacker.h"
 
-#include <vector>
-#include "Rectangle.h"
+#include <cmath>
+#include <algorithm>
 #include "rectangle-packing.h"
 #include "size-selectors.h"
 
@@ -64,31 +64,117 @@ int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstr
     return 0;
 }
 
-double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count, int width, int height, int padding, double unitRange, double pxRange, double miterLimit, double tolerance) {
-    bool lastResult = false;
-    #define TRY_PACK(scale) (lastResult = !tryPack(glyphs, count, DimensionsConstraint(), width, height, padding, (scale), unitRange+pxRange/(scale), miterLimit))
+bool TightAtlasPacker::tryScale(const GlyphGeometry *glyphs, int count, double scale, Trial &trial) const {
+    // Same boxes and packing order as placeGlyphs, but leaves the glyphs untouched so that trials can run concurrently
+    double range = unitRange+pxRange/scale;
+    trial.rectangles.clear();
+    for (const GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
+        if (!glyph->isWhitespace()) {
+            Rectangle rect = { };
+            glyph->measureBox(rect.w, rect.h, scale, range, miterLimit);
+            if (rect.w > 0 && rect.h > 0) {
+                rect.w += padding, rect.h += padding;
+                trial.rectangles.push_back(rect);
+            }
+        }
+    }
+    if (trial.rectangles.empty())
+        return true;
+    trial.packer.reset(width+padding, height+padding);
+    return !trial.packer.pack(trial.rectangles.data(), (int) trial.rectangles.size());
+}
+
+int TightAtlasPacker::tryScales(const GlyphGeometry *glyphs, int count, const std::vector<double> &scales, bool fit) {
+    std::vector<char> results(scales.size());
+    Workload workload([this, glyphs, count, &scales, &results](int i, int threadNo) -> bool {
+        results[i] = tryScale(glyphs, count, scales[i], trials[threadNo]);
+        return true;
+    }, (int) scales.size());
+    if (executor)
+        workload.finish(*executor);
+    else
+        workload.finish(threadCount);
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (bool(results[i]) != fit)
+            return (int) i;
+    }
+    return (int) results.size();
+}
+
+double TightAtlasPacker::packAndScale(const GlyphGeometry *glyphs, int count) {
+    // Each round tries as many candidate scales as there are threads, with a single thread this is a plain binary search
+    int candidates = std::max(executor ? executor->threadCount() : threadCount, 1);
+    trials.resize(candidates);
+    std::vector<double> scales(1, 1.);
     double minScale = 1, maxScale = 1;
-    if (TRY_PACK(1)) {
-        while (maxScale < 1e+32 && ((maxScale = 2*minScale), TRY_PACK(maxScale)))
-            minScale = maxScale;
-    } else {
-        while (minScale > 1e-32 && ((minScale = .5*maxScale), !TRY_PACK(minScale)))
+    if (tryScales(glyphs, count, scales, true)) {
+        scales.resize(candidates);
+        while (maxScale < 1e+32) {
+            for (int i = 0; i < candidates; ++i)
+                scales[i] = ldexp(minScale, i+1);
+            int failed = tryScales(glyphs, count, scales, true);
+            if (failed > 0)
+                minScale = scales[failed-1];
+            if (failed < candidates) {
+                maxScale = scales[failed];
+                break;
+            }
             maxScale = minScale;
+        }
+    } else {
+        scales.resize(candidates);
+        while (minScale > 1e-32) {
+            for (int i = 0; i < candidates; ++i)
+                scales[i] = ldexp(maxScale, -(i+1));
+            int fitted = tryScales(glyphs, count, scales, false);
+            if (fitted > 0)
+                maxScale = scales[fitted-1];
+            if (fitted < candidates) {
+                minScale = scales[fitted];
+                break;
+            }
+            minScale = maxScale;
+        }
     }
     if (minScale == maxScale)
         return 0;
-    while (minScale/maxScale < 1-tolerance) {
-        double midScale = .5*(minScale+maxScale);
-        if (TRY_PACK(midScale))
-            minScale = midScale;
-        else
-            maxScale = midScale;
+    while (minScale/maxScale < 1-scaleMaximizationTolerance) {
+        for (int i = 0; i < candidates; ++i)
+            scales[i] = minScale+(maxScale-minScale)*(i+1)/(candidates+1);
+        int failed = tryScales(glyphs, count, scales, true);
+        if (failed < candidates)
+            maxScale = scales[failed];
+        if (failed > 0)
+            minScale = scales[failed-1];
     }
-    if (!lastResult)
-        TRY_PACK(minScale);
     return minScale;
 }
 
+int TightAtlasPacker::placeGlyphs(GlyphGeometry *glyphs, int count, double range) {
+    rectangles.clear();
+    rectangleGlyphs.clear();
+    for (GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
+        if (!glyph->isWhitespace()) {
+            Rectangle rect = { };
+            glyph->wrapBox(scale, range, miterLimit);
+            glyph->getBoxSize(rect.w, rect.h);
+            if (rect.w > 0 && rect.h > 0) {
+                // Stays negative unless the packer places the rectangle
+                rect.x = -1;
+                rect.w += padding, rect.h += padding;
+                rectangles.push_back(rect);
+                rectangleGlyphs.push_back(glyph);
+            }
+        }
+    }
+    int result = packer.pack(rectangles.data(), (int) rectangles.size());
+    for (size_t i = 0; i < rectangles.size(); ++i) {
+        if (rectangles[i].x >= 0)
+            rectangleGlyphs[i]->placeBox(rectangles[i].x, height-(rectangles[i].y+rectangles[i].h-padding));
+    }
+    return result;
+}
+
 TightAtlasPacker::TightAtlasPacker() :
     width(-1), height(-1),
     padding(0),
@@ -98,25 +184,39 @@ TightAtlasPacker::TightAtlasPacker() :
     unitRange(0),
     pxRange(0),
     miterLimit(0),
-    scaleMaximizationTolerance(.001)
+    scaleMaximizationTolerance(.001),
+    threadCount(1),
+    executor(NULL)
 { }
 
 int TightAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
     double initialScale = scale > 0 ? scale : minScale;
     if (initialScale > 0) {
-        if (int remaining = tryPack(glyphs, count, dimensionsConstraint, width, height, padding, initialScale, unitRange+pxRange/initialScale, miterLimit))
-            return remaining;
+        // With both dimensions and scale fixed, placeGlyphs below does the only packing needed
+        if (width < 0 || height < 0 || scale <= 0) {
+            if (int remaining = tryPack(glyphs, count, dimensionsConstraint, width, height, padding, initialScale, unitRange+pxRange/initialScale, miterLimit))
+                return remaining;
+        }
     } else if (width < 0 || height < 0)
         return -1;
     if (scale <= 0)
-        scale = packAndScale(glyphs, count, width, height, padding, unitRange, pxRange, miterLimit, scaleMaximizationTolerance);
+        scale = packAndScale(glyphs, count);
     if (scale <= 0)
         return -1;
+    // The final layout is kept in the packer, so that append can fill the space left over
+    packer.reset(width+padding, height+padding);
+    if (int remaining = placeGlyphs(glyphs, count, unitRange+pxRange/scale))
+        return remaining;
     pxRange += scale*unitRange;
     unitRange = 0;
     return 0;
 }
 
+int TightAtlasPacker::append(GlyphGeometry *glyphs, int count) {
+    // Unit range has already been converted by pack
+    return placeGlyphs(glyphs, count, pxRange/scale);
+}
+
 void TightAtlasPacker::setDimensions(int width, int height) {
     this->width = width, this->height = height;
 }
@@ -153,6 +253,14 @@ void TightAtlasPacker::setMiterLimit(double miterLimit) {
     this->miterLimit = miterLimit;
 }
 
+void TightAtlasPacker::setThreadCount(int threadCount) {
+    this->threadCount = threadCount;
+}
+
+void TightAtlasPacker::setExecutor(WorkloadExecutor *executor) {
+    this->executor = executor;
+}
+
 void TightAtlasPacker::getDimensions(int &width, int &height) const {
     width = this->width, height = this->height;
 }
@@ -1,13 +1,19 @@
 
 #pragma once
 
+#include <vector>
+#include "Rectangle.h"
 #include "GlyphGeometry.h"
+#include "RectanglePacker.h"
+#include "Workload.h"
 
 namespace msdf_atlas {
 
 /**
  * This class computes the layout of a static atlas and may optionally
- * also find the minimum required dimensions and/or the maximum glyph scale
+ * also find the minimum required dimensions and/or the maximum glyph scale.
+ * The scale search evaluates several candidate scales per round in parallel
+ * if given multiple threads or an executor.
  */
 class TightAtlasPacker {
 
@@ -25,6 +31,8 @@ public:
 
     /// Computes the layout for the array of glyphs. Returns 0 on success
     int pack(GlyphGeometry *glyphs, int count);
+    /// Places more glyphs into the space left over by pack, at the same scale and without moving the glyphs already placed. Returns how many didn't fit (0 on success)
+    int append(GlyphGeometry *glyphs, int count);
 
     /// Sets the atlas's dimensions to be fixed
     void setDimensions(int width, int height);
@@ -44,6 +52,10 @@ public:
     void setPixelRange(double pxRange);
     /// Sets the miter limit for bounds computation
     void setMiterLimit(double miterLimit);
+    /// Sets the number of threads used to search for the maximum glyph scale
+    void setThreadCount(int threadCount);
+    /// Makes the scale search run on an external thread pool instead of its own threads, or stop if null
+    void setExecutor(WorkloadExecutor *executor);
 
     /// Outputs the atlas's final dimensions
     void getDimensions(int &width, int &height) const;
@@ -62,9 +74,26 @@ private:
     double pxRange;
     double miterLimit;
     double scaleMaximizationTolerance;
+    int threadCount;
+    WorkloadExecutor *executor;
+
+    /// Buffers reused by one thread's packing trials
+    struct Trial {
+        std::vector<Rectangle> rectangles;
+        RectanglePacker packer;
+    };
+    std::vector<Trial> trials;
+
+    /// Holds the space left over by pack for append
+    RectanglePacker packer;
+    std::vector<Rectangle> rectangles;
+    std::vector<GlyphGeometry *> rectangleGlyphs;
 
     static int tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, int padding, double scale, double range, double miterLimit);
-    static double packAndScale(GlyphGeometry *glyphs, int count, int width, int height, int padding, double unitRange, double pxRange, double miterLimit, double tolerance);
+    bool tryScale(const GlyphGeometry *glyphs, int count, double scale, Trial &trial) const;
+    int tryScales(const GlyphGeometry *glyphs, int count, const std::vector<double> &scales, bool fit);
+    double packAndScale(const GlyphGeometry *glyphs, int count);
+    int placeGlyphs(GlyphGeometry *glyphs, int count, double range);
 
 };
 
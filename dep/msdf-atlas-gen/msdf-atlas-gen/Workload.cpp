@@ -4,6 +4,9 @@
 #include <vector>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <memory>
+#include <condition_variable>
 #include <algorithm>
 
 namespace msdf_atlas {
@@ -12,6 +15,21 @@ Workload::Workload() : chunks(0) { }
 
 Workload::Workload(const std::function<bool(int, int)> &workerFunction, int chunks) : workerFunction(workerFunction), chunks(chunks) { }
 
+Workload::Workload(const std::function<bool(int, int)> &workerFunction, int chunks, const std::vector<double> &chunkCosts) : workerFunction(workerFunction), chunks(chunks) {
+    if ((int) chunkCosts.size() >= chunks) {
+        order.resize(chunks);
+        for (int i = 0; i < chunks; ++i)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&chunkCosts](int a, int b) {
+            return chunkCosts[a] > chunkCosts[b];
+        });
+    }
+}
+
+int Workload::chunk(int i) const {
+    return order.empty() ? i : order[i];
+}
+
 bool Workload::finishSequential() {
     for (int i = 0; i < chunks; ++i)
         if (!workerFunction(i, 0))
@@ -24,7 +42,7 @@ bool Workload::finishParallel(int threadCount) {
     std::atomic<int> next(0);
     std::function<void(int)> threadWorker = [this, &result, &next](int threadNo) {
         for (int i = next++; result && i < chunks; i = next++) {
-            if (!workerFunction(i, threadNo))
+            if (!workerFunction(chunk(i), threadNo))
                 result = false;
         }
     };
@@ -37,6 +55,50 @@ bool Workload::finishParallel(int threadCount) {
     return result;
 }
 
+bool Workload::finishExecutor(WorkloadExecutor &executor, int threadCount) {
+    // Tasks may start after finish has returned, so everything they touch before claiming a chunk is shared.
+    // Only tasks which claim a chunk call back into this object, and finish waits for every chunk.
+    struct State {
+        const Workload *workload;
+        int chunks;
+        std::atomic<int> next;
+        std::atomic<bool> result;
+        std::mutex mutex;
+        std::condition_variable condition;
+        int finished;
+    };
+    std::shared_ptr<State> state(new State);
+    state->workload = this;
+    state->chunks = chunks;
+    state->next = 0;
+    state->result = true;
+    state->finished = 0;
+
+    std::function<void(const std::shared_ptr<State> &, int)> threadWorker = [](const std::shared_ptr<State> &state, int threadNo) {
+        for (int i = state->next++; i < state->chunks; i = state->next++) {
+            if (state->result && !state->workload->workerFunction(state->workload->chunk(i), threadNo))
+                state->result = false;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                ++state->finished;
+            }
+            state->condition.notify_all();
+        }
+    };
+    for (int i = 1; i < threadCount; ++i)
+        executor.execute([state, threadWorker, i]() {
+            threadWorker(state, i);
+        });
+    threadWorker(state, 0);
+
+    // Chunks after a failure are claimed and skipped, so every chunk is eventually finished
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [this, &state]() {
+        return state->finished == chunks;
+    });
+    return state->result;
+}
+
 bool Workload::finish(int threadCount) {
     if (!chunks)
         return true;
@@ -47,4 +109,13 @@ bool Workload::finish(int threadCount) {
     return false;
 }
 
+bool Workload::finish(WorkloadExecutor &executor) {
+    if (!chunks)
+        return true;
+    int threadCount = executor.threadCount();
+    if (threadCount <= 1 || chunks == 1)
+        return finishSequential();
+    return finishExecutor(executor, std::min(threadCount, chunks));
+}
+
 }
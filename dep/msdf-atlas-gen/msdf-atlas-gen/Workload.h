@@ -2,30 +2,54 @@
 #pragma once
 
 #include <functional>
+#include <vector>
 
 namespace msdf_atlas {
 
+/**
+ * An external thread pool, such as the application's job system, which a Workload can run on
+ * instead of creating its own threads.
+ */
+class WorkloadExecutor {
+
+public:
+    virtual ~WorkloadExecutor() { }
+    /// Returns the number of tasks that can run at once, counting the thread which calls Workload::finish
+    virtual int threadCount() const = 0;
+    /// Schedules the task to run asynchronously. It must run eventually, but may start after the workload has finished.
+    virtual void execute(const std::function<void()> &task) = 0;
+
+};
+
 /**
  * This function allows to split a workload into multiple threads.
  * The worker function:
  *     bool FN(int chunk, int threadNo);
  * should process the given chunk (out of chunks) and return true.
  * If false is returned, the process is interrupted.
+ * If chunk costs are given, chunks are handed out from the most expensive,
+ * so that a few large chunks at the end can't leave the other threads idle.
  */
 class Workload {
 
 public:
     Workload();
     Workload(const std::function<bool(int, int)> &workerFunction, int chunks);
+    Workload(const std::function<bool(int, int)> &workerFunction, int chunks, const std::vector<double> &chunkCosts);
     /// Runs the process and returns true if all chunks have been processed
     bool finish(int threadCount);
+    /// Runs the process on the executor's threads and the calling thread, threadNo is below executor.threadCount()
+    bool finish(WorkloadExecutor &executor);
 
 private:
     std::function<bool(int, int)> workerFunction;
     int chunks;
+    std::vector<int> order;
 
+    int chunk(int i) const;
     bool finishSequential();
     bool finishParallel(int threadCount);
+    bool finishExecutor(WorkloadExecutor &executor, int threadCount);
 
 };
 
@@ -0,0 +1,69 @@
+
+#pragma once
+
+#include <vector>
+#include "Vector2.h"
+#include "Shape.h"
+#include "edge-selectors.h"
+#include "contour-combiners.h"
+
+#define MSDFGEN_BATCH_SIZE 8
+
+namespace msdfgen {
+
+/// Finds the distances between a Shape and batches of points inside a rectangular block, e.g. a few pixels of one row of a tile.
+/// Before the block is processed, edges which can't affect the distance anywhere inside it are culled.
+/// The distances to the remaining linear segments are evaluated for the whole batch at once by a kernel the compiler can vectorize.
+/// Culling is conservative and the kernel performs the same double precision operations as LinearSegment::signedDistance,
+/// so the results equal those of ShapeDistanceFinder, up to the rounding of fused multiply-add if the compiler emits it.
+template <class ContourCombiner>
+class BatchShapeDistanceFinder {
+
+public:
+    typedef typename ContourCombiner::DistanceType DistanceType;
+
+    // Passed shape object must persist until the distance finder is destroyed!
+    explicit BatchShapeDistanceFinder(const Shape &shape);
+    /// Culls the edges for points inside the rectangle. Must be called before distances.
+    void setBlock(double l, double b, double r, double t);
+    /// Finds the distances from up to MSDFGEN_BATCH_SIZE origins, which must lie inside the current block. Not thread-safe! Is fastest when subsequent origins are close together.
+    void distances(DistanceType *distances, const Point2 *origins, int count);
+    /// Returns the number of edges which weren't culled for the current block.
+    int blockEdgeCount() const;
+
+private:
+    struct Edge {
+        const EdgeSegment *edge;
+        EdgeEndGeometry ends;
+        int contour;
+        int selector;
+        int channels;
+        bool linear;
+    };
+
+    const Shape &shape;
+    ContourCombiner contourCombiner;
+    std::vector<typename ContourCombiner::EdgeSelectorType::EdgeCache> shapeEdgeCache;
+    std::vector<Edge> edges;
+    int selectorCount;
+
+    // Per edge, structure of arrays
+    std::vector<double> boundL, boundB, boundR, boundT;
+    std::vector<double> startX, startY, startDirX, startDirY;
+    std::vector<double> endX, endY, endDirX, endDirY;
+    std::vector<double> lowerBound, upperBound;
+
+    // Per selector and channel, the greatest distance from the block to its nearest edge
+    std::vector<double> channelUpperBound;
+
+    // Edges of the current block, and the linear segments among them
+    std::vector<int> blockEdges;
+    std::vector<int> blockLinearSlot;
+    std::vector<double> linearX0, linearY0, linearX1, linearY1;
+    std::vector<double> linearDistance, linearDot, linearParam;
+
+};
+
+}
+
+#include "BatchShapeDistanceFinder.hpp"
@@ -0,0 +1,199 @@
+
+#include "BatchShapeDistanceFinder.h"
+
+#include <cstddef>
+#include <cfloat>
+#include <cmath>
+#include "arithmetics.hpp"
+
+// An edge is culled if its distance from the block exceeds the upper bound by more than this factor, which absorbs rounding
+#define BATCH_CULL_FACTOR 1.001
+
+namespace msdfgen {
+
+inline int batchEdgeChannels(const EdgeSegment *edge, const double *) {
+    return 1;
+}
+
+inline int batchEdgeChannels(const EdgeSegment *edge, const MultiDistance *) {
+    return edge->color&WHITE;
+}
+
+/// Distance between the rectangle and the line through point along the unit vector dir.
+inline double batchLineDistance(double l, double b, double r, double t, double pointX, double pointY, double dirX, double dirY) {
+    double xl = (l-pointX)*dirY, xr = (r-pointX)*dirY;
+    double yb = (b-pointY)*dirX, yt = (t-pointY)*dirX;
+    double minCross = min(xl, xr)-max(yb, yt);
+    double maxCross = max(xl, xr)-min(yb, yt);
+    return max(max(minCross, -maxCross), 0.);
+}
+
+/// Distance between point and the farthest corner of the rectangle.
+inline double batchFarthestDistance(double l, double b, double r, double t, double pointX, double pointY) {
+    double dx = max(fabs(l-pointX), fabs(r-pointX));
+    double dy = max(fabs(b-pointY), fabs(t-pointY));
+    return sqrt(dx*dx+dy*dy);
+}
+
+template <class ContourCombiner>
+BatchShapeDistanceFinder<ContourCombiner>::BatchShapeDistanceFinder(const Shape &shape) : shape(shape), contourCombiner(shape), shapeEdgeCache(shape.edgeCount()), selectorCount(0) {
+    // The selectors are told apart by address, as SimpleContourCombiner shares one between all contours
+    std::vector<const void *> selectors;
+    edges.reserve(shape.edgeCount());
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        if (!contour->edges.empty()) {
+            int contourIndex = int(contour-shape.contours.begin());
+            const void *selectorAddress = &contourCombiner.edgeSelector(contourIndex);
+            int selector = 0;
+            while (selector < int(selectors.size()) && selectors[selector] != selectorAddress)
+                ++selector;
+            if (selector == int(selectors.size()))
+                selectors.push_back(selectorAddress);
+
+            // Same order as ShapeDistanceFinder, starting with the last edge
+            const EdgeSegment *prevEdge = contour->edges.size() >= 2 ? *(contour->edges.end()-2) : *contour->edges.begin();
+            const EdgeSegment *curEdge = contour->edges.back();
+            for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+                const EdgeSegment *nextEdge = *edge;
+                Edge entry;
+                entry.edge = curEdge;
+                entry.ends = EdgeEndGeometry(prevEdge, curEdge, nextEdge);
+                entry.contour = contourIndex;
+                entry.selector = selector;
+                entry.channels = batchEdgeChannels(curEdge, (const DistanceType *) NULL);
+                entry.linear = curEdge->type() == LinearSegment::EDGE_TYPE;
+                edges.push_back(entry);
+                prevEdge = curEdge;
+                curEdge = nextEdge;
+            }
+        }
+    }
+    selectorCount = int(selectors.size());
+
+    size_t edgeCount = edges.size();
+    boundL.resize(edgeCount), boundB.resize(edgeCount), boundR.resize(edgeCount), boundT.resize(edgeCount);
+    startX.resize(edgeCount), startY.resize(edgeCount), startDirX.resize(edgeCount), startDirY.resize(edgeCount);
+    endX.resize(edgeCount), endY.resize(edgeCount), endDirX.resize(edgeCount), endDirY.resize(edgeCount);
+    lowerBound.resize(edgeCount), upperBound.resize(edgeCount);
+    for (size_t i = 0; i < edgeCount; ++i) {
+        double l = DBL_MAX, b = DBL_MAX, r = -DBL_MAX, t = -DBL_MAX;
+        edges[i].edge->bound(l, b, r, t);
+        boundL[i] = l, boundB[i] = b, boundR[i] = r, boundT[i] = t;
+        // The selectors take pseudo-distances from the lines extending the edge at its endpoints
+        const EdgeEndGeometry &ends = edges[i].ends;
+        startX[i] = ends.a.x, startY[i] = ends.a.y, startDirX[i] = ends.aDir.x, startDirY[i] = ends.aDir.y;
+        endX[i] = ends.b.x, endY[i] = ends.b.y, endDirX[i] = ends.bDir.x, endDirY[i] = ends.bDir.y;
+    }
+}
+
+template <class ContourCombiner>
+void BatchShapeDistanceFinder<ContourCombiner>::setBlock(double l, double b, double r, double t) {
+    int edgeCount = int(edges.size());
+
+    // No point inside the block is closer to an edge than its lower bound, and every point inside is within the upper bound of at least one of its endpoints
+    for (int i = 0; i < edgeCount; ++i) {
+        double dx = max(max(boundL[i]-r, l-boundR[i]), 0.);
+        double dy = max(max(boundB[i]-t, b-boundT[i]), 0.);
+        double boxDistance = sqrt(dx*dx+dy*dy);
+        double startDistance = batchLineDistance(l, b, r, t, startX[i], startY[i], startDirX[i], startDirY[i]);
+        double endDistance = batchLineDistance(l, b, r, t, endX[i], endY[i], endDirX[i], endDirY[i]);
+        lowerBound[i] = min(boxDistance, min(startDistance, endDistance));
+        upperBound[i] = min(batchFarthestDistance(l, b, r, t, startX[i], startY[i]), batchFarthestDistance(l, b, r, t, endX[i], endY[i]));
+    }
+
+    channelUpperBound.assign(3*selectorCount, DBL_MAX);
+    for (int i = 0; i < edgeCount; ++i) {
+        double *channelBound = &channelUpperBound[3*edges[i].selector];
+        for (int channel = 0; channel < 3; ++channel)
+            if (edges[i].channels&(1<<channel))
+                channelBound[channel] = min(channelBound[channel], upperBound[i]);
+    }
+
+    // An edge is kept if it may be the nearest for one of its channels. Otherwise, neither its true distance nor its pseudo-distances can win.
+    blockEdges.clear();
+    blockLinearSlot.clear();
+    linearX0.clear(), linearY0.clear(), linearX1.clear(), linearY1.clear();
+    for (int i = 0; i < edgeCount; ++i) {
+        const double *channelBound = &channelUpperBound[3*edges[i].selector];
+        bool relevant = false;
+        for (int channel = 0; channel < 3; ++channel)
+            if (edges[i].channels&(1<<channel) && lowerBound[i] <= BATCH_CULL_FACTOR*channelBound[channel])
+                relevant = true;
+        if (!relevant)
+            continue;
+        blockEdges.push_back(i);
+        if (edges[i].linear) {
+            const LinearSegment *linear = static_cast<const LinearSegment *>(edges[i].edge);
+            blockLinearSlot.push_back(int(linearX0.size()));
+            linearX0.push_back(linear->p[0].x), linearY0.push_back(linear->p[0].y);
+            linearX1.push_back(linear->p[1].x), linearY1.push_back(linear->p[1].y);
+        } else
+            blockLinearSlot.push_back(-1);
+    }
+    linearDistance.resize(MSDFGEN_BATCH_SIZE*linearX0.size());
+    linearDot.resize(MSDFGEN_BATCH_SIZE*linearX0.size());
+    linearParam.resize(MSDFGEN_BATCH_SIZE*linearX0.size());
+}
+
+template <class ContourCombiner>
+void BatchShapeDistanceFinder<ContourCombiner>::distances(DistanceType *distances, const Point2 *origins, int count) {
+    // Unused lanes repeat the last origin, so the kernel always runs over the full batch
+    double originX[MSDFGEN_BATCH_SIZE], originY[MSDFGEN_BATCH_SIZE];
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i) {
+        const Point2 &origin = origins[i < count ? i : count-1];
+        originX[i] = origin.x;
+        originY[i] = origin.y;
+    }
+
+    // Batched LinearSegment::signedDistance, written without branches so that it vectorizes
+    int linearCount = int(linearX0.size());
+    for (int j = 0; j < linearCount; ++j) {
+        double x0 = linearX0[j], y0 = linearY0[j], x1 = linearX1[j], y1 = linearY1[j];
+        Vector2 ab(x1-x0, y1-y0);
+        double abSquared = dotProduct(ab, ab);
+        Vector2 orthonormal = ab.getOrthonormal(false);
+        Vector2 direction = ab.normalize();
+        double *distance = &linearDistance[MSDFGEN_BATCH_SIZE*j];
+        double *dot = &linearDot[MSDFGEN_BATCH_SIZE*j];
+        double *param = &linearParam[MSDFGEN_BATCH_SIZE*j];
+        for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i) {
+            double aqX = originX[i]-x0, aqY = originY[i]-y0;
+            double t = (aqX*ab.x+aqY*ab.y)/abSquared;
+            double eqX = (t > .5 ? x1 : x0)-originX[i];
+            double eqY = (t > .5 ? y1 : y0)-originY[i];
+            double endpointDistance = sqrt(eqX*eqX+eqY*eqY);
+            double orthoDistance = orthonormal.x*aqX+orthonormal.y*aqY;
+            double cross = aqX*ab.y-aqY*ab.x;
+            double eqDirX = endpointDistance == 0 ? 0. : eqX/endpointDistance;
+            double eqDirY = endpointDistance == 0 ? 1. : eqY/endpointDistance;
+            bool ortho = t > 0 && t < 1 && fabs(orthoDistance) < endpointDistance;
+            distance[i] = ortho ? orthoDistance : (cross > 0 ? endpointDistance : -endpointDistance);
+            dot[i] = ortho ? 0. : fabs(direction.x*eqDirX+direction.y*eqDirY);
+            param[i] = t;
+        }
+    }
+
+    int edgeCount = int(blockEdges.size());
+    for (int i = 0; i < count; ++i) {
+        contourCombiner.reset(origins[i]);
+        for (int k = 0; k < edgeCount; ++k) {
+            int index = blockEdges[k];
+            const Edge &edge = edges[index];
+            typename ContourCombiner::EdgeSelectorType &edgeSelector = contourCombiner.edgeSelector(edge.contour);
+            int slot = blockLinearSlot[k];
+            if (slot >= 0) {
+                int lane = MSDFGEN_BATCH_SIZE*slot+i;
+                edgeSelector.addEdge(shapeEdgeCache[index], edge.edge, edge.ends, SignedDistance(linearDistance[lane], linearDot[lane]), linearParam[lane]);
+            } else
+                edgeSelector.addEdge(shapeEdgeCache[index], edge.edge, edge.ends);
+        }
+        distances[i] = contourCombiner.distance();
+    }
+}
+
+template <class ContourCombiner>
+int BatchShapeDistanceFinder<ContourCombiner>::blockEdgeCount() const {
+    return int(blockEdges.size());
+}
+
+}
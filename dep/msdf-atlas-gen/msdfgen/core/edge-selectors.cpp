@@ -8,6 +8,19 @@ namespace msdfgen {
 
 #define DISTANCE_DELTA_FACTOR 1.001
 
+EdgeEndGeometry::EdgeEndGeometry() { }
+
+EdgeEndGeometry::EdgeEndGeometry(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge) {
+    a = edge->point(0);
+    b = edge->point(1);
+    aDir = edge->direction(0).normalize(true);
+    bDir = edge->direction(1).normalize(true);
+    Vector2 prevDir = prevEdge->direction(1).normalize(true);
+    Vector2 nextDir = nextEdge->direction(0).normalize(true);
+    aDomainDir = (prevDir+aDir).normalize(true);
+    bDomainDir = (bDir+nextDir).normalize(true);
+}
+
 TrueDistanceSelector::EdgeCache::EdgeCache() : absDistance(0) { }
 
 void TrueDistanceSelector::reset(const Point2 &p) {
@@ -16,18 +29,37 @@ void TrueDistanceSelector::reset(const Point2 &p) {
     this->p = p;
 }
 
-void TrueDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge) {
+bool TrueDistanceSelector::isEdgeRelevant(const EdgeCache &cache) const {
     double delta = DISTANCE_DELTA_FACTOR*(p-cache.point).length();
-    if (cache.absDistance-delta <= fabs(minDistance.distance)) {
+    return cache.absDistance-delta <= fabs(minDistance.distance);
+}
+
+void TrueDistanceSelector::addRelevantEdge(EdgeCache &cache, const SignedDistance &distance) {
+    if (distance < minDistance)
+        minDistance = distance;
+    cache.point = p;
+    cache.absDistance = fabs(distance.distance);
+}
+
+void TrueDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge) {
+    if (isEdgeRelevant(cache)) {
+        double dummy;
+        addRelevantEdge(cache, edge->signedDistance(p, dummy));
+    }
+}
+
+void TrueDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends) {
+    if (isEdgeRelevant(cache)) {
         double dummy;
-        SignedDistance distance = edge->signedDistance(p, dummy);
-        if (distance < minDistance)
-            minDistance = distance;
-        cache.point = p;
-        cache.absDistance = fabs(distance.distance);
+        addRelevantEdge(cache, edge->signedDistance(p, dummy));
     }
 }
 
+void TrueDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends, const SignedDistance &distance, double param) {
+    if (isEdgeRelevant(cache))
+        addRelevantEdge(cache, distance);
+}
+
 void TrueDistanceSelector::merge(const TrueDistanceSelector &other) {
     if (other.minDistance < minDistance)
         minDistance = other.minDistance;
@@ -130,33 +162,46 @@ void PseudoDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEd
     if (isEdgeRelevant(cache, edge, p)) {
         double param;
         SignedDistance distance = edge->signedDistance(p, param);
-        addEdgeTrueDistance(edge, distance, param);
-        cache.point = p;
-        cache.absDistance = fabs(distance.distance);
-
-        Vector2 ap = p-edge->point(0);
-        Vector2 bp = p-edge->point(1);
-        Vector2 aDir = edge->direction(0).normalize(true);
-        Vector2 bDir = edge->direction(1).normalize(true);
-        Vector2 prevDir = prevEdge->direction(1).normalize(true);
-        Vector2 nextDir = nextEdge->direction(0).normalize(true);
-        double add = dotProduct(ap, (prevDir+aDir).normalize(true));
-        double bdd = -dotProduct(bp, (bDir+nextDir).normalize(true));
-        if (add > 0) {
-            double pd = distance.distance;
-            if (getPseudoDistance(pd, ap, -aDir))
-                addEdgePseudoDistance(pd = -pd);
-            cache.aPseudoDistance = pd;
-        }
-        if (bdd > 0) {
-            double pd = distance.distance;
-            if (getPseudoDistance(pd, bp, bDir))
-                addEdgePseudoDistance(pd);
-            cache.bPseudoDistance = pd;
-        }
-        cache.aDomainDistance = add;
-        cache.bDomainDistance = bdd;
+        addRelevantEdge(cache, edge, EdgeEndGeometry(prevEdge, edge, nextEdge), distance, param);
+    }
+}
+
+void PseudoDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends) {
+    if (isEdgeRelevant(cache, edge, p)) {
+        double param;
+        SignedDistance distance = edge->signedDistance(p, param);
+        addRelevantEdge(cache, edge, ends, distance, param);
+    }
+}
+
+void PseudoDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends, const SignedDistance &distance, double param) {
+    if (isEdgeRelevant(cache, edge, p))
+        addRelevantEdge(cache, edge, ends, distance, param);
+}
+
+void PseudoDistanceSelector::addRelevantEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends, const SignedDistance &distance, double param) {
+    addEdgeTrueDistance(edge, distance, param);
+    cache.point = p;
+    cache.absDistance = fabs(distance.distance);
+
+    Vector2 ap = p-ends.a;
+    Vector2 bp = p-ends.b;
+    double add = dotProduct(ap, ends.aDomainDir);
+    double bdd = -dotProduct(bp, ends.bDomainDir);
+    if (add > 0) {
+        double pd = distance.distance;
+        if (getPseudoDistance(pd, ap, -ends.aDir))
+            addEdgePseudoDistance(pd = -pd);
+        cache.aPseudoDistance = pd;
+    }
+    if (bdd > 0) {
+        double pd = distance.distance;
+        if (getPseudoDistance(pd, bp, ends.bDir))
+            addEdgePseudoDistance(pd);
+        cache.bPseudoDistance = pd;
     }
+    cache.aDomainDistance = add;
+    cache.bDomainDistance = bdd;
 }
 
 PseudoDistanceSelector::DistanceType PseudoDistanceSelector::distance() const {
@@ -171,59 +216,76 @@ void MultiDistanceSelector::reset(const Point2 &p) {
     this->p = p;
 }
 
-void MultiDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge) {
-    if (
+bool MultiDistanceSelector::isEdgeRelevant(const EdgeCache &cache, const EdgeSegment *edge) const {
+    return (
         (edge->color&RED && r.isEdgeRelevant(cache, edge, p)) ||
         (edge->color&GREEN && g.isEdgeRelevant(cache, edge, p)) ||
         (edge->color&BLUE && b.isEdgeRelevant(cache, edge, p))
-    ) {
+    );
+}
+
+void MultiDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge) {
+    if (isEdgeRelevant(cache, edge)) {
         double param;
         SignedDistance distance = edge->signedDistance(p, param);
-        if (edge->color&RED)
-            r.addEdgeTrueDistance(edge, distance, param);
-        if (edge->color&GREEN)
-            g.addEdgeTrueDistance(edge, distance, param);
-        if (edge->color&BLUE)
-            b.addEdgeTrueDistance(edge, distance, param);
-        cache.point = p;
-        cache.absDistance = fabs(distance.distance);
-
-        Vector2 ap = p-edge->point(0);
-        Vector2 bp = p-edge->point(1);
-        Vector2 aDir = edge->direction(0).normalize(true);
-        Vector2 bDir = edge->direction(1).normalize(true);
-        Vector2 prevDir = prevEdge->direction(1).normalize(true);
-        Vector2 nextDir = nextEdge->direction(0).normalize(true);
-        double add = dotProduct(ap, (prevDir+aDir).normalize(true));
-        double bdd = -dotProduct(bp, (bDir+nextDir).normalize(true));
-        if (add > 0) {
-            double pd = distance.distance;
-            if (PseudoDistanceSelectorBase::getPseudoDistance(pd, ap, -aDir)) {
-                pd = -pd;
-                if (edge->color&RED)
-                    r.addEdgePseudoDistance(pd);
-                if (edge->color&GREEN)
-                    g.addEdgePseudoDistance(pd);
-                if (edge->color&BLUE)
-                    b.addEdgePseudoDistance(pd);
-            }
-            cache.aPseudoDistance = pd;
+        addRelevantEdge(cache, edge, EdgeEndGeometry(prevEdge, edge, nextEdge), distance, param);
+    }
+}
+
+void MultiDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends) {
+    if (isEdgeRelevant(cache, edge)) {
+        double param;
+        SignedDistance distance = edge->signedDistance(p, param);
+        addRelevantEdge(cache, edge, ends, distance, param);
+    }
+}
+
+void MultiDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends, const SignedDistance &distance, double param) {
+    if (isEdgeRelevant(cache, edge))
+        addRelevantEdge(cache, edge, ends, distance, param);
+}
+
+void MultiDistanceSelector::addRelevantEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends, const SignedDistance &distance, double param) {
+    if (edge->color&RED)
+        r.addEdgeTrueDistance(edge, distance, param);
+    if (edge->color&GREEN)
+        g.addEdgeTrueDistance(edge, distance, param);
+    if (edge->color&BLUE)
+        b.addEdgeTrueDistance(edge, distance, param);
+    cache.point = p;
+    cache.absDistance = fabs(distance.distance);
+
+    Vector2 ap = p-ends.a;
+    Vector2 bp = p-ends.b;
+    double add = dotProduct(ap, ends.aDomainDir);
+    double bdd = -dotProduct(bp, ends.bDomainDir);
+    if (add > 0) {
+        double pd = distance.distance;
+        if (PseudoDistanceSelectorBase::getPseudoDistance(pd, ap, -ends.aDir)) {
+            pd = -pd;
+            if (edge->color&RED)
+                r.addEdgePseudoDistance(pd);
+            if (edge->color&GREEN)
+                g.addEdgePseudoDistance(pd);
+            if (edge->color&BLUE)
+                b.addEdgePseudoDistance(pd);
         }
-        if (bdd > 0) {
-            double pd = distance.distance;
-            if (PseudoDistanceSelectorBase::getPseudoDistance(pd, bp, bDir)) {
-                if (edge->color&RED)
-                    r.addEdgePseudoDistance(pd);
-                if (edge->color&GREEN)
-                    g.addEdgePseudoDistance(pd);
-                if (edge->color&BLUE)
-                    b.addEdgePseudoDistance(pd);
-            }
-            cache.bPseudoDistance = pd;
+        cache.aPseudoDistance = pd;
+    }
+    if (bdd > 0) {
+        double pd = distance.distance;
+        if (PseudoDistanceSelectorBase::getPseudoDistance(pd, bp, ends.bDir)) {
+            if (edge->color&RED)
+                r.addEdgePseudoDistance(pd);
+            if (edge->color&GREEN)
+                g.addEdgePseudoDistance(pd);
+            if (edge->color&BLUE)
+                b.addEdgePseudoDistance(pd);
         }
-        cache.aDomainDistance = add;
-        cache.bDomainDistance = bdd;
+        cache.bPseudoDistance = pd;
     }
+    cache.aDomainDistance = add;
+    cache.bDomainDistance = bdd;
 }
 
 void MultiDistanceSelector::merge(const MultiDistanceSelector &other) {
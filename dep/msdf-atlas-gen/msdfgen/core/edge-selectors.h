@@ -14,6 +14,17 @@ struct MultiAndTrueDistance : MultiDistance {
     double a;
 };
 
+/// The endpoints of an edge and its directions there, which don't depend on the point and can be computed once per edge.
+struct EdgeEndGeometry {
+    Point2 a, b;
+    Vector2 aDir, bDir;
+    /// Bisectors of the corners with the previous and next edge.
+    Vector2 aDomainDir, bDomainDir;
+
+    EdgeEndGeometry();
+    EdgeEndGeometry(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+};
+
 /// Selects the nearest edge by its true distance.
 class TrueDistanceSelector {
 
@@ -29,6 +40,9 @@ public:
 
     void reset(const Point2 &p);
     void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    /// Same as above with precomputed end geometry, and optionally the signed distance from the current point already evaluated.
+    void addEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends);
+    void addEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends, const SignedDistance &distance, double param);
     void merge(const TrueDistanceSelector &other);
     DistanceType distance() const;
 
@@ -36,6 +50,9 @@ private:
     Point2 p;
     SignedDistance minDistance;
 
+    bool isEdgeRelevant(const EdgeCache &cache) const;
+    void addRelevantEdge(EdgeCache &cache, const SignedDistance &distance);
+
 };
 
 class PseudoDistanceSelectorBase {
@@ -78,11 +95,15 @@ public:
 
     void reset(const Point2 &p);
     void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    void addEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends);
+    void addEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends, const SignedDistance &distance, double param);
     DistanceType distance() const;
 
 private:
     Point2 p;
 
+    void addRelevantEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends, const SignedDistance &distance, double param);
+
 };
 
 /// Selects the nearest edge for each of the three channels by its pseudo-distance.
@@ -94,6 +115,8 @@ public:
 
     void reset(const Point2 &p);
     void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    void addEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends);
+    void addEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends, const SignedDistance &distance, double param);
     void merge(const MultiDistanceSelector &other);
     DistanceType distance() const;
     SignedDistance trueDistance() const;
@@ -102,6 +125,9 @@ private:
     Point2 p;
     PseudoDistanceSelectorBase r, g, b;
 
+    bool isEdgeRelevant(const EdgeCache &cache, const EdgeSegment *edge) const;
+    void addRelevantEdge(EdgeCache &cache, const EdgeSegment *edge, const EdgeEndGeometry &ends, const SignedDistance &distance, double param);
+
 };
 
 /// Selects the nearest edge for each of the three color channels by its pseudo-distance and by true distance for the alpha channel.
@@ -6,6 +6,7 @@
 #include "edge-selectors.h"
 #include "contour-combiners.h"
 #include "ShapeDistanceFinder.h"
+#include "BatchShapeDistanceFinder.h"
 
 namespace msdfgen {
 
@@ -53,24 +54,42 @@ public:
 template <class ContourCombiner>
 void generateDistanceField(const typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapRefType &output, const Shape &shape, const Projection &projection, double range) {
     DistancePixelConversion<typename ContourCombiner::DistanceType> distancePixelConversion(range);
+    // The output is processed in square blocks, each row of a block is one batch
+    int bandCount = (output.height+MSDFGEN_BATCH_SIZE-1)/MSDFGEN_BATCH_SIZE;
 #ifdef MSDFGEN_USE_OPENMP
     #pragma omp parallel
 #endif
     {
-        ShapeDistanceFinder<ContourCombiner> distanceFinder(shape);
+        BatchShapeDistanceFinder<ContourCombiner> distanceFinder(shape);
+        Point2 origins[MSDFGEN_BATCH_SIZE];
+        typename ContourCombiner::DistanceType distances[MSDFGEN_BATCH_SIZE];
         bool rightToLeft = false;
 #ifdef MSDFGEN_USE_OPENMP
         #pragma omp for
 #endif
-        for (int y = 0; y < output.height; ++y) {
-            int row = shape.inverseYAxis ? output.height-y-1 : y;
-            for (int col = 0; col < output.width; ++col) {
-                int x = rightToLeft ? output.width-col-1 : col;
-                Point2 p = projection.unproject(Point2(x+.5, y+.5));
-                typename ContourCombiner::DistanceType distance = distanceFinder.distance(p);
-                distancePixelConversion(output(x, row), distance);
+        for (int band = 0; band < bandCount; ++band) {
+            int y0 = band*MSDFGEN_BATCH_SIZE;
+            int y1 = min(y0+MSDFGEN_BATCH_SIZE, output.height);
+            for (int x0 = 0; x0 < output.width; x0 += MSDFGEN_BATCH_SIZE) {
+                int x1 = min(x0+MSDFGEN_BATCH_SIZE, output.width);
+                Point2 a = projection.unproject(Point2(x0+.5, y0+.5));
+                Point2 b = projection.unproject(Point2(x1-.5, y1-.5));
+                distanceFinder.setBlock(min(a.x, b.x), min(a.y, b.y), max(a.x, b.x), max(a.y, b.y));
+                for (int y = y0; y < y1; ++y) {
+                    int row = shape.inverseYAxis ? output.height-y-1 : y;
+                    int count = x1-x0;
+                    for (int i = 0; i < count; ++i) {
+                        int x = rightToLeft ? x1-i-1 : x0+i;
+                        origins[i] = projection.unproject(Point2(x+.5, y+.5));
+                    }
+                    distanceFinder.distances(distances, origins, count);
+                    for (int i = 0; i < count; ++i) {
+                        int x = rightToLeft ? x1-i-1 : x0+i;
+                        distancePixelConversion(output(x, row), distances[i]);
+                    }
+                    rightToLeft = !rightToLeft;
+                }
             }
-            rightToLeft = !rightToLeft;
         }
     }
 }
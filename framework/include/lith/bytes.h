@@ -12,6 +12,9 @@ public:
 	void setRaw(int itemSize, int byteCount, void* bytes);
 	void clear();
 
+	// Keep the first 'count' items, or add zeroed ones up to it
+	void resize(int count);
+
 	int size() const;
 	int count() const;
 	const void* data() const;
@@ -46,6 +49,17 @@ public:
 		}
 	}
 
+	// Copy an array of items in at once, _t should be the item type
+	template<typename _t>
+	void addMany(const _t* items, int count) {
+		if (itemSize != sizeof(_t)) {
+			throw nullptr;
+		}
+
+		const char* begin = (const char*)items;
+		raw.insert(raw.end(), begin, begin + count * sizeof(_t));
+	}
+
 	template<typename _t>
 	void add(const _t& item) {
 		if (itemSize == 0) {
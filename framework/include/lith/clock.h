@@ -5,4 +5,27 @@ float lithTotalTime();
 
 float lithGetTime();
 
-void lithUpdateTime();
\ No newline at end of file
+void lithUpdateTime();
+
+// Frame pacing
+//	lithWaitForFrame should be called once at the end of each frame.
+//	It sleeps for most of the remaining frame time, then spins for the
+//	last part, which the OS scheduler can't be trusted to hit.
+
+// A frame limit of 0 disables waiting
+void lithSetFrameLimit(float framesPerSecond);
+float lithGetFrameLimit();
+
+void lithWaitForFrame();
+
+// Statistics over the last lithFrameStatsCount frame times, in seconds
+constexpr int lithFrameStatsCount = 256;
+
+struct lithFrameStats {
+	float p50;
+	float p99;
+	float max;
+	int count;
+};
+
+lithFrameStats lithGetFrameStats();
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "lith/line.h"
+#include "lith/shape.h"
+#include "lith/polygon.h"
+#include "lith/meshrender.h"
+#include "lith/pointcloud.h"
+#include "lith/font.h"
+
+#include <vector>
+#include <string>
+
+class RetainedShape;
+
+// A list of draw calls which can be recorded on any thread, then submitted to a
+// RenderBackendInterface on the main thread. Lines and shapes are stored in the
+// layout their renderers upload, so submitting them is a copy.
+class RenderCommandList {
+public:
+	struct TextCommand {
+		vec2 position;
+		float size;
+		TextMeshGenerationConfig config;
+		const Font* font;
+		std::string text;
+	};
+
+	struct MeshCommand {
+		const CachedMesh* mesh;
+		MeshInstance instance;
+	};
+
+	struct PointCloudCommand {
+		const PointCloud* cloud;
+		Transform2D transform;
+	};
+
+	struct RetainedCommand {
+		const RetainedShape* shape;
+		Transform2D transform;
+	};
+
+	void line(vec3 positionBegin, vec3 positionEnd, vec4 stroke, float strokeThickness, StrokeCap cap);
+	void lineSegments(const LineMesh::InstanceVertexData* segments, int count);
+	void rect(vec2 position, vec2 size, float rotation, vec4 fill, vec4 stroke, float strokeThickness);
+	void shape(const ShapeMesh::InstanceVertexData& shape);
+	void polygon(const PolygonMesh::VertexData* vertices, int vertexCount, const uint32_t* indices, int indexCount);
+	void text(vec2 position, float size, TextMeshGenerationConfig config, const Font& font, const std::string& text);
+	void mesh(const CachedMesh& mesh, const MeshInstance& instance);
+	void pointCloud(const PointCloud& cloud, const Transform2D& transform);
+	void retained(const RetainedShape& shape, const Transform2D& transform);
+
+	// Add the commands of another list after the commands of this one
+	void append(const RenderCommandList& list);
+
+	// Keeps the memory so lists can be reused each frame without allocating
+	void clear();
+	bool empty() const;
+
+public:
+	std::vector<LineMesh::InstanceVertexData> lines;
+	std::vector<ShapeMesh::InstanceVertexData> shapes;
+	std::vector<PolygonMesh::VertexData> polygonVertices;
+	std::vector<uint32_t> polygonIndices; // into polygonVertices
+	std::vector<TextCommand> texts;
+	std::vector<MeshCommand> meshes;
+	std::vector<PointCloudCommand> pointClouds;
+	std::vector<RetainedCommand> retainedShapes;
+};
@@ -8,6 +8,11 @@
 #include "lith/log.h"
 #include "lith/ui.h"
 #include "lith/font.h"
+#include "lith/clock.h"
+#include "lith/profile.h"
+#include "lith/job.h"
+#include "lith/meshcache.h"
+#include "lith/transform.h"
 
 struct AppContext {
     bool running;
@@ -23,6 +28,9 @@ struct AppContext {
     LoggerInterface* logger;
     UIContext* ui;
     FontGeneratorInterface* fontGenerator;
+    ProfileContext* profile;
+    JobExecutor* jobs;
+    MeshCacheContext* meshes;
 };
 
 struct PluginContext {
@@ -38,17 +46,23 @@ struct SketchContext {
     float deltaTime;
     float totalTime;
 
+    // frame times measured by the runtime
+    lithFrameStats frameStats;
+
      // applies to line and rect
  	vec4 stroke = vec4(1);
 
     // applies to rect
  	vec4 fill = vec4(1);
 
-    // applies to rect
-    // todo: apply to line
+    // applies to line and rect
  	float strokeThickness = 1;
     float strokeThicknessRestore = 1;
 
+    // applies to line and shapes
+    StrokeCap strokeCap = StrokeCapRound;
+    StrokeJoin strokeJoin = StrokeJoinMiter;
+
     const Font* font; // take the pointer to the ref held
                       // user must keep this alive
 
@@ -59,4 +73,16 @@ struct SketchContext {
     TextAlign alignY = TextAlignBaseline;
 
     vec4 background;
+
+    // applied to everything drawn, reset at the start of each frame
+    Transform2D matrix;
+    std::vector<Transform2D> matrixStack;
+
+    // from the mesh cache, set by __setContext and sphereDetail
+    const CachedMesh* boxMesh = nullptr;
+    const CachedMesh* sphereMesh = nullptr;
+
+    // values from keep, serialized when the sketch is unloaded because
+    // the memory of its globals goes away with the old library
+    std::vector<char> state;
 };
\ No newline at end of file
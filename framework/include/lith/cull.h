@@ -0,0 +1,45 @@
+#pragma once
+
+#include "lith/math.h"
+#include "lith/bytes.h"
+
+#include <vector>
+#include <cstdint>
+
+// View culling for 2D instances
+//	When a batch is drawn its instances are boxed into SoA arrays and tested against the part of
+//	the xy plane the camera can see, in a loop simple enough for the compiler to vectorize. Boxes
+//	may be larger than what's drawn, nothing visible is ever dropped. The instances which pass are
+//	packed to the front of the batch, so only they are uploaded.
+
+// The box the camera sees, between its near and far planes
+struct ViewBounds {
+	vec2 min;
+	vec2 max;
+};
+
+// Everything is inside when the view can't be boxed, like a perspective camera looking along the plane
+ViewBounds getViewBounds(const mat4& viewProj);
+
+struct CullStats {
+	int instanceCount;
+	int visibleCount;
+};
+
+// The boxes of a batch, reused between frames
+struct CullBoxes {
+	std::vector<float> minX;
+	std::vector<float> minY;
+	std::vector<float> maxX;
+	std::vector<float> maxY;
+	std::vector<uint8_t> visible;
+
+	void resize(int count);
+	void set(int index, vec2 min, vec2 max);
+
+	// Set which boxes overlap the view, returns how many do
+	int cull(const ViewBounds& view);
+};
+
+// Move the visible items to the front, keeping their order, and drop the rest
+void keepVisible(ByteVector& items, const uint8_t* visible, int visibleCount);
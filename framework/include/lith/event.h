@@ -1,13 +1,16 @@
 #pragma once
 
 #include "lith/input.h"
+#include "lith/ring.h"
 
-#include <vector>
+#include <cstdint>
+#include <type_traits>
 
-enum EventType {
+enum EventType : uint8_t {
 	lithWindowResize,
 	lithWindowTitle,
 	lithWindowVSync,
+	lithFrameRate,
 	lithExit,
 
 	lithRecompilePlugin,
@@ -31,6 +34,11 @@ struct EventWindowVSync {
 	int interval;
 };
 
+struct EventFrameRate {
+	int framelimit; // 0 for no limit
+	bool loop;
+};
+
 struct EventExit {
 	int code;
 };
@@ -38,17 +46,18 @@ struct EventExit {
 struct EventRecompilePlugin {
 };
 
+// flags are packed into bits to keep lithEvent small, it's copied through the rings by value
+
 struct EventKey {
 	KeyboardInput keycode;
 
 	char key;
+	uint8_t repeat;
 
-	bool state;
-	int repeat;
-
-	bool key_shift;
-	bool key_ctrl;
-	bool key_alt;
+	bool state     : 1;
+	bool key_shift : 1;
+	bool key_ctrl  : 1;
+	bool key_alt   : 1;
 };
 
 struct EventMouse {
@@ -58,17 +67,17 @@ struct EventMouse {
 	float screen_x, screen_y;
 	float vel_x, vel_y;
 
-	bool button_left;
-	bool button_middle;
-	bool button_right;
-	bool button_x1;
-	bool button_x2;
+	uint8_t button_repeat;
 
-	int button_repeat;
+	bool button_left   : 1;
+	bool button_middle : 1;
+	bool button_right  : 1;
+	bool button_x1     : 1;
+	bool button_x2     : 1;
 
 	// If this is true, this mouse event is from the mouse wheel being scrolled
 	// vel_x and vel_y hold the direction of scrolling
-	bool is_wheel;
+	bool is_wheel : 1;
 };
 
 struct EventController {
@@ -94,12 +103,14 @@ struct EventInput {
 struct lithEvent {
 	EventType type;
 
-	~lithEvent() noexcept {}
+	// EventInput can't be default constructed, so the rings need this to fill their slots
+	lithEvent() : type(lithExit), windowResize{} {}
 
 	union {
 		EventWindowResize windowResize;
 		EventWindowTitle windowTitle;
 		EventWindowVSync windowVSync;
+		EventFrameRate frameRate;
 		EventExit exit;
 		EventRecompilePlugin recompilePlugin;
 		EventKey key;
@@ -109,9 +120,41 @@ struct lithEvent {
 	};
 };
 
+static_assert(std::is_trivially_copyable_v<lithEvent>, "lithEvent is copied through the rings as bytes");
+
 using lithEventHandler = void(*)(const lithEvent&);
 
+constexpr size_t EventRingCapacity = 1024;
+
+// A fixed size queue of events from one producer to one consumer.
+//	Mouse motion is held back and merged with the motion after it, keeping the last position
+//	and the summed velocity, so a high rate mouse sends one motion per frame instead of one
+//	per report. Any other event publishes the held motion first, so clicks stay ordered with
+//	the position they happened at.
+class EventRing {
+public:
+	// Returns false and drops the event if the consumer is a whole ring behind. An event
+	// which would have to go ahead of the held motion is dropped as well
+	bool push(const lithEvent& event);
+
+	// Publish the held back motion, call after the last push of a frame. Returns false
+	// if the ring is full, the motion is held until the next flush
+	bool flush();
+
+	// Call read(const lithEvent&) on each published event in order
+	template<typename _read>
+	void consume(_read&& read) {
+		while (ring.try_consume(read)) {}
+	}
+
+private:
+	spsc_ring<lithEvent, EventRingCapacity> ring;
+
+	lithEvent motion = {};
+	bool hasMotion = false;
+};
+
 struct EventPipe {
-	std::vector<lithEvent> out;
-	std::vector<lithEvent> in;
+	EventRing out; // from the plugin to the runtime
+	EventRing in;  // from the runtime to the plugin
 };
\ No newline at end of file
@@ -4,13 +4,37 @@
 #include "glm/vec3.hpp"
 #include "glm/geometric.hpp"
 #include <vector>
+#include <span>
 
 using namespace glm;
 
+class JobExecutor;
+
 struct Icosphere {
 	std::vector<int> index;
 	std::vector<vec3> pos;
 	std::vector<vec2> uvs;
 };
 
-Icosphere MakeIcosphere(int resolution);
\ No newline at end of file
+// Interleaved layout, can be passed straight to VertexArrayBuilder::data
+// with attributes f3 (pos) and f2 (uv)
+struct IcosphereVertex {
+	vec3 pos;
+	vec2 uv;
+};
+
+// Exact sizes of the buffers for a resolution
+int IcosphereVertexCount(int resolution);
+int IcosphereIndexCount(int resolution);
+
+// If jobs is not null, the faces are split across its threads and this waits for them.
+// Don't call this from inside of a job of the same executor.
+
+Icosphere MakeIcosphere(int resolution, JobExecutor* jobs = nullptr);
+
+// Reuse the memory of an existing sphere
+void MakeIcosphere(int resolution, Icosphere& sphere, JobExecutor* jobs = nullptr);
+
+// Write into caller-provided buffers, which must be at least the sizes above
+void MakeIcosphere(int resolution, std::span<vec3> pos, std::span<vec2> uvs, std::span<int> index, JobExecutor* jobs = nullptr);
+void MakeIcosphere(int resolution, std::span<IcosphereVertex> vertices, std::span<int> index, JobExecutor* jobs = nullptr);
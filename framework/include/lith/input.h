@@ -25,6 +25,7 @@ using InputMask = std::string;
 // This is for the events to be able to pass a trivially copyable type
 struct InputNameRef {
 	const InputName* name;
+	InputNameRef() = default;
 	InputNameRef(const InputName& name) : name(&name) {}
 	operator const InputName&() const { return *name; }
 };
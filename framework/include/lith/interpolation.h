@@ -2,6 +2,8 @@
 
 #include "lith/math.h"
 
+#include <vector>
+
 class LinearInterpolator {
 public:
 	LinearInterpolator(vec2 start, vec2 end, float stepSize);
@@ -17,4 +19,23 @@ private:
 
 	int curStep;
 	int totalSteps;
-};
\ No newline at end of file
+};
+
+// Curves are flattened into points for the line renderer. The number of segments of each curve
+// comes from Wang's formula, from how far its control points bend away from a line, so flat
+// curves get a few and tight ones many. 'tolerance' is the largest distance allowed between the
+// curve and its segments, in world units.
+
+// The number of segments a cubic bezier needs to stay within 'tolerance'
+int bezierSegmentCount(vec2 p0, vec2 p1, vec2 p2, vec2 p3, float tolerance);
+
+// Evaluate a cubic bezier at 'count' parameters. The points are worked out in batches, written
+// so the compiler can vectorize them
+void evaluateBezier(vec2 p0, vec2 p1, vec2 p2, vec2 p3, const float* t, int count, vec2* out);
+
+// Append the points of the curve after its start to 'out', the start is the last point of the
+// line it continues
+void flattenBezier(vec2 p0, vec2 p1, vec2 p2, vec2 p3, float tolerance, std::vector<vec2>& out);
+
+// Catmull-Rom spline from p1 to p2, p0 and p3 shape the tangents
+void flattenCatmullRom(vec2 p0, vec2 p1, vec2 p2, vec2 p3, float tolerance, std::vector<vec2>& out);
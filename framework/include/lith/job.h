@@ -10,6 +10,7 @@
 #include <iostream>
 #include <deque>
 #include <mutex>
+#include <memory>
 
 template<typename _t>
 class tsque
@@ -239,6 +240,8 @@ public:
 	// Create a tree which the executor will free when it is done
 	JobTree& CreateTree();
 
+	int ThreadCount() const;
+
 private:
 	struct JobThreadContext
 	{
@@ -258,6 +261,7 @@ private:
 	void DestroyThreads();
 
 private:
+	std::mutex ownedTreesMutex;
 	std::vector<JobTree*> ownedTrees;
 
 	tsque<JobNode*> wavefront;
@@ -268,6 +272,36 @@ private:
 	int workCount = 0;
 };
 
+// JobWait
+//	Blocks a thread until a job has run. The signal is shared with the job, so the
+//	waiter can return and go out of scope while the job is still signalling.
+//
+//	Example:
+//		JobWait wait;
+//		wait.After(tree.CreateEmpty().For(items, perItem));
+//		jobs->Run(tree);
+//		wait.Wait();
+
+class JobWait
+{
+public:
+	JobWait();
+
+	// Signal after 'job' and everything it joins, call before the tree is run
+	void After(Job job);
+	void Wait();
+
+private:
+	struct State
+	{
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool done = false;
+	};
+
+	std::shared_ptr<State> state;
+};
+
 //
 //	Template impl
 //
@@ -2,12 +2,39 @@
 
 #include "lith/mesh.h"
 #include "lith/shader.h"
+#include "lith/cull.h"
+
+// How the open ends of a line are drawn
+enum StrokeCap {
+	StrokeCapRound,
+	StrokeCapSquare,  // ends at the endpoint
+	StrokeCapProject  // square, extended by half the weight
+};
+
+// How the segments of a shape meet. Miters sharper than the limit are drawn round
+enum StrokeJoin {
+	StrokeJoinMiter,
+	StrokeJoinRound
+};
 
 class LineMesh {
 public:
-	struct LineVertex {
-		vec3 pos;
-		vec4 stroke;
+	// Each segment is one instance, expanded to a quad in the vertex shader. 'before' and 'after'
+	// are the points next to 'a' and 'b' in the shape, and shape the joins. If they equal 'a' or 'b'
+	// that end is capped. Lines are expanded in the xy plane.
+	// 48 bytes, see packColor and packHalf
+	struct InstanceVertexData {
+		vec3 a; // 0
+		vec3 b; // 12
+		vec2 before; // 24
+		vec2 after; // 32
+		uint32_t stroke; // 40, RGBA8
+		uint16_t weight; // 44, half
+		uint8_t style; // 46, cap | join << 2
+	};
+
+	struct QuadVertexData {
+		vec2 pos; // x is the end, y is the side
 	};
 
 	void create();
@@ -15,17 +42,32 @@ public:
 	void draw();
 	void clear();
 
-	void addLine(vec3 a, vec3 b, vec4 stroke, float strokeThickness);
+	void addLine(vec3 a, vec3 b, vec4 stroke, float weight, StrokeCap cap);
+	void addLines(const InstanceVertexData* segments, int count);
+
+	// Drop the segments outside of the view before they're uploaded. The boxes are padded for
+	// the widest miter and the anti-aliased edge
+	CullStats cull(const ViewBounds& view, float pixelSize);
+
+	// Retained meshes are uploaded once and drawn as they are, parts can be replaced after
+	void upload();
+	void drawUploaded() const;
+	void setLines(int first, const InstanceVertexData* segments, int count);
 
 private:
 	VertexArray mesh;
+	VertexBuffer* instances;
+	CullBoxes boxes;
 };
 
+LineMesh::InstanceVertexData makeLineSegment(vec3 a, vec3 b, vec2 before, vec2 after, vec4 stroke, float weight, StrokeCap cap, StrokeJoin join);
+
 struct LineShaderProgram {
 	void create();
 	void free();
 
-	void use(const mat4& view, const mat4& proj);
+	// 'pixelSize' is the size of a pixel in world units, the quads are padded by it for the anti-aliased edge
+	void use(const mat4& view, const mat4& proj, float pixelSize);
 
 private:
 	ShaderProgram program;
@@ -35,12 +77,21 @@ class LineRenderer {
 public:
 	void create();
 	void free();
-	void draw(const mat4& view, const mat4& proj);
+	void draw(const mat4& view, const mat4& proj, float pixelSize);
 	void clear();
 
-	void addLine(vec3 a, vec3 b, vec4 stroke, float strokeThickness);
+	void addLine(vec3 a, vec3 b, vec4 stroke, float weight, StrokeCap cap);
+	void addLines(const LineMesh::InstanceVertexData* segments, int count);
+
+	// Draw a retained mesh with this renderer's program
+	void drawMesh(const LineMesh& mesh, const mat4& view, const mat4& proj, float pixelSize);
+
+	// How many segments were drawn last time out of how many were added
+	const CullStats& stats() const;
 
 private:
 	LineShaderProgram shader;
 	LineMesh mesh;
-};
\ No newline at end of file
+
+	CullStats lastStats = {};
+};
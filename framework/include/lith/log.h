@@ -2,6 +2,11 @@
 
 #include "fmt/core.h"
 
+// Logging
+//	print can be called from any thread. The format string is checked at compile time,
+//	and short messages are formatted on the stack, so most calls don't allocate.
+//	The backend is expected to copy the string before log returns.
+
 class LoggerInterface {
 public:
 	virtual void log(const char* str) = 0;
@@ -12,7 +17,17 @@ void registerLoggerInterface(LoggerInterface* logger);
 void print(const char* str);
 
 template<typename... _args>
-void print(const char* format, const _args&... args) {
-	std::string str = fmt::format(fmt::runtime(format), args...);
-	print(str.c_str());
-}
\ No newline at end of file
+void print(fmt::format_string<const _args&...> format, const _args&... args) {
+	char buffer[256];
+	auto result = fmt::format_to_n(buffer, sizeof(buffer) - 1, format, args...);
+
+	if (result.size < sizeof(buffer)) {
+		buffer[result.size] = '\0';
+		print(buffer);
+	}
+
+	else {
+		std::string str = fmt::format(format, args...);
+		print(str.c_str());
+	}
+}
@@ -4,6 +4,8 @@
 #include "lith/bytes.h"
 #include "lith/typedef.h"
 
+#include <cstdint>
+
 enum VertexArrayTopology {
 	TopologyTriangles,
 	TopologyTriangleStrip,
@@ -16,11 +18,22 @@ enum VertexArrayTopology {
 
 enum VertexArrayAttributeType {
 	AttributeTypeFloat,
-	AttributeTypeInt
+	AttributeTypeInt,
+	AttributeTypeHalf,       // 16 bit float
+	AttributeTypeUShortNorm, // 16 bit unsigned int, read as [0, 1] in the shader
+	AttributeTypeUByte,      // 8 bit unsigned int, read as a float in the shader
+	AttributeTypeUByteNorm   // 8 bit unsigned int, read as [0, 1] in the shader
 };
 
 GLenum getVertexArrayTopology(VertexArrayTopology topology);
 GLenum getVertexArrayAttributeType(VertexArrayAttributeType type);
+int getVertexArrayAttributeTypeSize(VertexArrayAttributeType type);
+bool isVertexArrayAttributeNormalized(VertexArrayAttributeType type);
+
+// Packed attribute values. Colors are RGBA8 for AttributeTypeUByteNorm, with r in the first byte
+uint32_t packColor(vec4 color);
+uint16_t packHalf(float value);
+float unpackHalf(uint16_t value);
 
 struct VertexBuffer {
 	int id;
@@ -91,11 +104,18 @@ public:
 
 	VertexArray& upload();
 
+	// Upload the items in [first, first + count) of a buffer which was uploaded before,
+	// after changing them on the host
+	VertexArray& uploadRange(int bufferID, int first, int count);
+
 	void free();
 	void clear();
 	void clearInstances();
 
-	void draw();
+	void draw() const;
+
+	// Draw the mesh 'instanceCount' times, for instance data which isn't in a vertex attribute
+	void drawInstanced(int instanceCount) const;
 
 private:
     VertexArrayData data;
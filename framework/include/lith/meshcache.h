@@ -0,0 +1,103 @@
+#pragma once
+
+#include "lith/mesh.h"
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+// Mesh cache
+//	The procedural meshes are generated, optimized and uploaded once for each set of
+//	parameters, then shared by everyone who asks for the same mesh. The cache is owned
+//	by the runtime, so meshes survive a sketch reload. The cache holds plain pointers,
+//	so nothing it owns calls back into the module which created it, which can be a
+//	sketch that has since been unloaded.
+//
+//	Must be called on the thread which owns the OpenGL context.
+
+enum MeshGenerator {
+	MeshGeneratorIcosphere,
+	MeshGeneratorUVSphere,
+	MeshGeneratorCapsule,
+	MeshGeneratorPlane,
+	MeshGeneratorBox
+};
+
+enum MeshLayout {
+	MeshLayoutFloat,    // MeshVertex
+	MeshLayoutQuantized // MeshVertexQuantized
+};
+
+struct MeshOptions {
+	bool optimizeVertexCache = true;
+	bool optimizeVertexFetch = true;
+	MeshLayout layout = MeshLayoutFloat;
+};
+
+// Both layouts have the position in attribute 0 and uv in attribute 1
+
+struct MeshVertex {
+	vec3 pos;
+	vec2 uv;
+};
+
+struct MeshVertexQuantized {
+	uint16_t pos[4]; // half float, the 4th is padding
+	uint16_t uv[2];  // unorm
+};
+
+struct MeshStats {
+	int vertexCount;
+	int indexCount;
+	int vertexBytes;
+
+	// average cache miss ratio with a 32 entry FIFO, before and after optimizing
+	float acmrBefore;
+	float acmrAfter;
+};
+
+struct CachedMesh {
+	VertexArray mesh;
+	MeshStats stats;
+
+	// radius of a sphere around the origin which holds every vertex
+	float radius;
+};
+
+struct MeshKey {
+	MeshGenerator generator;
+	int ints[2];
+	float floats[2];
+	MeshOptions options;
+
+	bool operator==(const MeshKey& other) const;
+};
+
+struct MeshKeyHash {
+	size_t operator()(const MeshKey& key) const;
+};
+
+struct MeshCacheContext {
+	std::mutex mutex;
+	std::unordered_map<MeshKey, CachedMesh*, MeshKeyHash> meshes;
+
+	// counts the clears, so anything keyed by mesh pointers can drop its stale keys
+	int generation = 0;
+};
+
+void registerMeshCacheContext(MeshCacheContext* context);
+
+// The meshes are owned by the cache, and stay valid until lithMeshCacheClear
+
+const CachedMesh* lithMeshIcosphere(int resolution, const MeshOptions& options = {});
+const CachedMesh* lithMeshUVSphere(int latCount, int lonCount, const MeshOptions& options = {});
+const CachedMesh* lithMeshCapsule(int resolution, float height, float radius, const MeshOptions& options = {});
+const CachedMesh* lithMeshPlane(int xCount, int yCount, const MeshOptions& options = {});
+
+// A cube from (-0.5, -0.5, -0.5) to (0.5, 0.5, 0.5), with separate vertices for each face
+const CachedMesh* lithMeshBox(const MeshOptions& options = {});
+
+// Free every mesh in the cache, pointers to them can't be used after this
+void lithMeshCacheClear();
+
+// Changes each time the cache is cleared
+int lithMeshCacheGeneration();
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+// Index buffer optimization for triangle lists
+
+// Reorder triangles so vertices are reused while they are still in the GPU's post-transform
+// cache, using Tom Forsyth's "Linear-Speed Vertex Cache Optimisation". Winding is kept.
+void lithOptimizeVertexCache(std::span<int> index, int vertexCount);
+
+// Renumber vertices in the order the index first uses them, so vertex fetches walk
+// forward through memory. Unused vertices are moved to the end.
+// Return the remap table, where remap[oldVertex] = newVertex. Use lithRemapVertices to apply it.
+std::vector<int> lithOptimizeVertexFetch(std::span<int> index, int vertexCount);
+
+template<typename _t>
+void lithRemapVertices(std::vector<_t>& vertices, const std::vector<int>& remap) {
+	std::vector<_t> remapped(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++) {
+		remapped[remap[i]] = vertices[i];
+	}
+
+	vertices.swap(remapped);
+}
+
+// Average cache miss ratio, the number of vertices transformed per triangle with
+// a FIFO cache of 'cacheSize' entries. 0.5 is the best case for a regular grid, 3 the worst
+float lithMeasureACMR(std::span<const int> index, int vertexCount, int cacheSize = 32);
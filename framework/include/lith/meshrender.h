@@ -0,0 +1,99 @@
+#pragma once
+
+#include "lith/meshcache.h"
+#include "lith/shader.h"
+#include "lith/lens.h"
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+class JobExecutor;
+
+// Stored in a texture buffer as 4 texels, read in the vertex shader with gl_InstanceID.
+// This lets the shared meshes from the cache be drawn instanced without changing their vertex arrays.
+struct MeshInstance {
+	vec4 position; // w is unused
+	vec4 scale;    // w is unused
+	vec4 rotation; // quaternion as xyzw
+	vec4 color;
+};
+
+MeshInstance makeMeshInstance(vec3 position, vec3 scale, quat rotation, vec4 color);
+
+class MeshProgram {
+public:
+	void create();
+	void free();
+
+	void use(const mat4& view, const mat4& proj);
+	void setInstanceOffset(int offset);
+
+private:
+	ShaderProgram program;
+};
+
+struct MeshRenderStats {
+	int instanceCount;
+	int visibleCount;
+	int drawCount;
+};
+
+// Instances are gathered per mesh into SoA bounding spheres for culling. Each frame they are
+// culled against the view frustum, split over the job threads when there are many.
+// Opaque instances are drawn with one draw call per mesh. Instances with alpha < 1 are sorted
+// back to front and drawn after, with one draw call per run of the same mesh.
+class MeshRenderer {
+public:
+	void create();
+	void free();
+	void draw(const mat4& view, const mat4& proj, JobExecutor* jobs = nullptr);
+	void clear();
+
+	// The mesh must stay alive until the next clear
+	void addMesh(const CachedMesh& mesh, const MeshInstance& instance);
+
+	const MeshRenderStats& stats() const;
+
+private:
+	struct Batch {
+		const CachedMesh* mesh;
+
+		// bounding spheres
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> radius;
+
+		std::vector<MeshInstance> instances;
+		std::vector<uint8_t> visible;
+	};
+
+	struct Transparent {
+		float depth;
+		int batch;
+		int instance;
+	};
+
+	Batch& getBatch(const CachedMesh& mesh);
+	void cull(const mat4& viewProj, JobExecutor* jobs);
+
+private:
+	MeshProgram program;
+
+	std::vector<Batch> batches;
+	std::unordered_map<const CachedMesh*, int> batchIndex;
+	int lastBatch = -1;
+
+	// the batches are dropped when the cache is cleared, a new mesh can reuse an address
+	int meshGeneration = 0;
+
+	// reused each frame
+	std::vector<MeshInstance> upload;
+	std::vector<Transparent> transparent;
+
+	GLuint instanceBuffer = 0;
+	GLuint instanceTexture = 0;
+
+	MeshRenderStats lastStats = {};
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "lith/shader.h"
+#include "lith/lens.h"
+#include "lith/transform.h"
+
+#include <vector>
+#include <cstdint>
+
+class JobExecutor;
+
+// Point clouds
+//	Points are uploaded once into a buffer which only grows, and drawn from it with GL_POINTS.
+//	Each append is split into chunks, and the points of a chunk are reordered so every level of
+//	detail is a prefix of it. Level l keeps the first point in each cell of a 2^l by 2^l grid over
+//	the chunk, so when zoomed out each chunk draws one point for each pixel it covers. Moving the
+//	camera only changes how many points of each chunk are drawn, nothing is uploaded again.
+
+// 20 bytes, the color is RGBA8
+struct PointVertex {
+	vec3 pos;
+	float size; // in pixels
+	uint8_t color[4];
+};
+
+PointVertex makePoint(vec3 position, float size, vec4 color);
+
+// the finest grid has 2^PointLevelCount cells on a side, points sharing a cell there
+// are only drawn once zoomed in past it
+constexpr int PointLevelCount = 12;
+
+class PointCloud {
+public:
+	struct Chunk {
+		int first; // into the buffer
+		int count;
+
+		vec3 min;
+		vec3 max;
+
+		// how many points are drawn at each level, the last is every point
+		int levels[PointLevelCount + 2];
+	};
+
+	PointCloud();
+
+	void create();
+	void free();
+
+	// Add points after the ones already uploaded. The chunks are binned on the job threads
+	// when 'jobs' isn't null. Call on the thread which owns the OpenGL context.
+	void append(const PointVertex* points, int count, JobExecutor* jobs = nullptr);
+
+	// Drop every point, the buffer is kept for the next appends
+	void clear();
+
+	int size() const;
+	const std::vector<Chunk>& getChunks() const;
+
+	// Draw the chunks in the view with as many points as the camera needs, returns how many
+	// were drawn. Use with PointCloudProgram and the same transform
+	int draw(const CameraLens& lens, int viewportHeight, const Transform2D& transform) const;
+
+private:
+	// Grow the buffer on the GPU, copying the points which were uploaded
+	void reserve(int capacity);
+
+	GLuint vertexArray;
+	GLuint buffer;
+	int capacity;
+	int pointCount;
+
+	std::vector<Chunk> chunks;
+};
+
+class PointCloudProgram {
+public:
+	void create();
+	void free();
+
+	void use(const mat4& view, const mat4& proj, const Transform2D& transform);
+
+private:
+	ShaderProgram program;
+};
+
+struct PointCloudRenderStats {
+	int pointCount;
+	int drawnCount;
+};
+
+// Draws the clouds added each frame, under a transform for each
+class PointCloudRenderer {
+public:
+	void create();
+	void free();
+	void draw(const CameraLens& lens, int viewportHeight);
+	void clear();
+
+	// The cloud must stay alive until the next clear
+	void addPointCloud(const PointCloud& cloud, const Transform2D& transform);
+
+	const PointCloudRenderStats& stats() const;
+
+private:
+	struct Item {
+		const PointCloud* cloud;
+		Transform2D transform;
+	};
+
+	PointCloudProgram program;
+	std::vector<Item> items;
+
+	PointCloudRenderStats lastStats = {};
+};
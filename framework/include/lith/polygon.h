@@ -0,0 +1,59 @@
+#pragma once
+
+#include "lith/mesh.h"
+#include "lith/shader.h"
+
+// Filled polygons, tessellated into triangles on the CPU (see lith/tessellate.h) and
+// drawn from one indexed vertex array
+class PolygonMesh {
+public:
+	// 16 bytes, see packColor
+	struct VertexData {
+		vec3 pos;
+		uint32_t color; // RGBA8
+	};
+
+	void create();
+	void free();
+	void draw();
+	void clear();
+
+	// The indices are into 'vertices'
+	void addPolygon(const VertexData* vertices, int vertexCount, const uint32_t* indices, int indexCount);
+
+	// Retained meshes are uploaded once and drawn as they are, vertices can be replaced after
+	void upload();
+	void drawUploaded() const;
+	void setVertices(int first, const VertexData* vertices, int count);
+
+private:
+	VertexArray mesh;
+};
+
+class PolygonProgram {
+public:
+	void create();
+	void free();
+
+	void use(const mat4& view, const mat4& proj);
+
+private:
+	ShaderProgram program;
+};
+
+class PolygonRenderer {
+public:
+	void create();
+	void free();
+	void draw(const mat4& view, const mat4& proj);
+	void clear();
+
+	void addPolygon(const PolygonMesh::VertexData* vertices, int vertexCount, const uint32_t* indices, int indexCount);
+
+	// Draw a retained mesh with this renderer's program
+	void drawMesh(const PolygonMesh& mesh, const mat4& view, const mat4& proj);
+
+private:
+	PolygonProgram shader;
+	PolygonMesh mesh;
+};
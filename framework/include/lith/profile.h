@@ -0,0 +1,152 @@
+#pragma once
+
+#include "lith/typedef.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Profiling
+//	LITH_PROFILE_SCOPE records the time between its construction and the end of the scope.
+//	Each thread records into its own ring buffer without locking, lithProfileFrame
+//	collects the buffers from every thread into a frame once per frame.
+//
+//	LITH_PROFILE_GPU_SCOPE records the same on the GPU using timestamp queries. These can
+//	only be used on the thread which owns the OpenGL context. Their results are read
+//	back a few frames late, so they don't stall the pipeline.
+//
+//	Names must be string literals, or outlive the call to lithProfileFrame.
+
+#define LITH_PROFILE_CONCAT_(a, b) a##b
+#define LITH_PROFILE_CONCAT(a, b) LITH_PROFILE_CONCAT_(a, b)
+
+#define LITH_PROFILE_SCOPE(name) ProfileScope LITH_PROFILE_CONCAT(_lithProfileScope, __LINE__)(name)
+#define LITH_PROFILE_GPU_SCOPE(name) ProfileGPUScope LITH_PROFILE_CONCAT(_lithProfileGPUScope, __LINE__)(name)
+
+constexpr int ProfileThreadCapacity = 1 << 14;
+constexpr int ProfileMaxDepth = 64;
+constexpr int ProfileFrameCount = 120;
+constexpr int ProfileGPULatency = 4;
+
+// The thread index used for events from LITH_PROFILE_GPU_SCOPE
+constexpr int ProfileGPUThread = -1;
+
+struct ProfileEvent {
+	const char* name;
+	int64_t begin; // ns
+	int64_t end;
+	int depth;
+};
+
+// Only the owning thread writes events and head, only lithProfileFrame reads
+// them and writes tail. If the owner gets more than ProfileThreadCapacity
+// events ahead, the oldest are dropped.
+struct ProfileThreadBuffer {
+	ProfileEvent events[ProfileThreadCapacity];
+	std::atomic<uint64_t> head = 0;
+	uint64_t tail = 0;
+
+	// scopes which have begun but not ended
+	const char* openName[ProfileMaxDepth];
+	int64_t openBegin[ProfileMaxDepth];
+	int depth = 0;
+
+	int thread = 0;
+};
+
+struct ProfileFrameEvent {
+	int name;   // index into ProfileContext::names
+	int thread; // ProfileGPUThread for GPU events
+	int depth;
+	int64_t begin;
+	int64_t end;
+};
+
+struct ProfileFrame {
+	int64_t id = -1;
+	int64_t begin = 0;
+	int64_t end = 0;
+	int thread = 0; // the thread which called lithProfileFrame
+	std::vector<ProfileFrameEvent> events;
+};
+
+struct ProfileGPUQuery {
+	const char* name;
+	int depth;
+	GLuint begin;
+	GLuint end;
+};
+
+struct ProfileGPUFrame {
+	int64_t id = -1;
+	int64_t cpuTime = 0; // used to line the gpu timestamps up with the cpu clock
+	int64_t gpuTime = 0;
+	std::vector<ProfileGPUQuery> queries;
+};
+
+struct ProfileContext {
+	bool enabled = true;
+
+	// One buffer for each thread, shared by the runtime and the sketch plugin. Each module
+	// looks its buffer up by thread id, so a reloaded plugin finds the same buffers again
+	std::mutex threadsMutex;
+	std::vector<ProfileThreadBuffer*> threads;
+	std::unordered_map<std::thread::id, ProfileThreadBuffer*> threadBuffers;
+
+	// the thread which calls lithProfileFrame
+	int mainThread = 0;
+
+	std::vector<std::string> names;
+	std::unordered_map<std::string, int> nameIndex;
+
+	// cleared when a context is registered, because a reloaded plugin
+	// can put different strings at the same addresses
+	std::unordered_map<const char*, int> namePointers;
+
+	// ring of the last ProfileFrameCount frames
+	ProfileFrame frames[ProfileFrameCount];
+	int64_t frameId = 0;
+	int64_t frameBegin = 0;
+
+	ProfileGPUFrame gpuFrames[ProfileGPULatency];
+	std::vector<GLuint> gpuQueryPool;
+	std::vector<int> gpuOpen;
+
+	~ProfileContext();
+};
+
+void registerProfileContext(ProfileContext* context);
+
+// Time in ns from a monotonic clock
+int64_t lithProfileTime();
+
+// Close the current frame by collecting the events from all threads, and read back any
+// finished GPU queries. Call once per frame on the thread which owns the OpenGL context.
+void lithProfileFrame();
+
+// Return the last finished frame 'framesAgo' frames back, or nullptr if out of the history
+const ProfileFrame* lithProfileGetFrame(int framesAgo);
+const char* lithProfileGetName(int name);
+
+// Write the frame history as a Chrome trace (chrome://tracing, or ui.perfetto.dev)
+bool lithProfileWriteChromeTrace(const char* filepath);
+
+void lithProfileBegin(const char* name);
+void lithProfileEnd();
+
+void lithProfileBeginGPU(const char* name);
+void lithProfileEndGPU();
+
+struct ProfileScope {
+	ProfileScope(const char* name) { lithProfileBegin(name); }
+	~ProfileScope() { lithProfileEnd(); }
+};
+
+struct ProfileGPUScope {
+	ProfileGPUScope(const char* name) { lithProfileBeginGPU(name); }
+	~ProfileGPUScope() { lithProfileEndGPU(); }
+};
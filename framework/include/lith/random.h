@@ -1,8 +1,125 @@
 #pragma once
 
 #include "lith/math.h"
+#include <cstdint>
+#include <span>
+
+// Engines
+//	All satisfy UniformRandomBitGenerator, so they can be used with the std distributions.
+//	SplitMix64 is only used to expand seeds, Xoshiro256ss backs the rand_* functions.
+
+struct SplitMix64 {
+	using result_type = uint64_t;
+
+	uint64_t state;
+
+	SplitMix64(uint64_t seed = 0) : state(seed) {}
+
+	uint64_t operator()() {
+		uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	static constexpr uint64_t min() { return 0; }
+	static constexpr uint64_t max() { return UINT64_MAX; }
+};
+
+struct Xoshiro256ss {
+	using result_type = uint64_t;
+
+	uint64_t s[4];
+
+	Xoshiro256ss(uint64_t seed = 0) { this->seed(seed); }
+
+	void seed(uint64_t seed) {
+		SplitMix64 split(seed);
+		for (uint64_t& x : s) {
+			x = split();
+		}
+	}
+
+	uint64_t operator()() {
+		uint64_t result = rotl(s[1] * 5, 7) * 9;
+		uint64_t t = s[1] << 17;
+
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+
+		return result;
+	}
+
+	// Advance 2^128 calls, used to split off non-overlapping sequences
+	void jump() {
+		static constexpr uint64_t polynomial[] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+
+		uint64_t t[4] = {};
+		for (uint64_t word : polynomial) {
+			for (int bit = 0; bit < 64; bit++) {
+				if (word & (1ull << bit)) {
+					for (int i = 0; i < 4; i++) {
+						t[i] ^= s[i];
+					}
+				}
+				(*this)();
+			}
+		}
+
+		for (int i = 0; i < 4; i++) {
+			s[i] = t[i];
+		}
+	}
+
+	static constexpr uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+	static constexpr uint64_t min() { return 0; }
+	static constexpr uint64_t max() { return UINT64_MAX; }
+};
+
+struct PCG32 {
+	using result_type = uint32_t;
+
+	uint64_t state;
+	uint64_t inc;
+
+	PCG32(uint64_t seed = 0, uint64_t stream = 0) { this->seed(seed, stream); }
+
+	void seed(uint64_t seed, uint64_t stream = 0) {
+		state = 0;
+		inc = (stream << 1) | 1;
+		(*this)();
+		state += seed;
+		(*this)();
+	}
+
+	uint32_t operator()() {
+		uint64_t old = state;
+		state = old * 6364136223846793005ull + inc;
+		uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+		uint32_t rot = (uint32_t)(old >> 59);
+		return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+	}
+
+	static constexpr uint32_t min() { return 0; }
+	static constexpr uint32_t max() { return UINT32_MAX; }
+};
+
+// Streams
+//	Each thread draws from its own engine, so the rand_* functions are safe to call from jobs.
+//	Every engine is derived from the seed and a stream index. The thread which calls rand_seed
+//	uses stream 0, other threads get the next free index the first time they draw.
+//	For results which don't depend on thread scheduling, pick the stream explicitly,
+//	e.g. rand_stream(batch) at the start of each batch in JobExecutor::For.
 
 void rand_seed(int seed);
+void rand_stream(int stream);
+
+// The engine of the calling thread
+Xoshiro256ss& rand_engine();
 
 int rand_i();
 bool rand_b();
@@ -59,6 +176,22 @@ vec3 rand_3fcmmn(float minRadius, float maxRadius);
 
 vec2 rand_outside_box(float extentX, float extentY, float paddingX, float paddingY);
 
+// Bulk
+//	Fill arrays from 8 interleaved generators, which the compiler can vectorize.
+//	These advance a separate per-thread state, so they don't change the sequence
+//	of the single value functions.
+
+void rand_fill_f(std::span<float> out);
+void rand_fill_fmm(std::span<float> out, float min, float max);
+void rand_fill_im(std::span<int> out, int max);
+
+void rand_2f_n(std::span<vec2> out);
+void rand_2fmm_n(std::span<vec2> out, vec2 min, vec2 max);
+void rand_3fmm_n(std::span<vec3> out, vec3 min, vec3 max);
+
+void rand_2fcn_n(std::span<vec2> out, float radius);
+void rand_3fcn_n(std::span<vec3> out, float radius);
+
 template<typename _enum>
 _enum rand_e(_enum count) {
 	return static_cast<_enum>(rand_im(count));
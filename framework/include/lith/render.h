@@ -4,6 +4,8 @@
 #include "lith/font.h"
 #include "lith/lens.h"
 #include "lith/texture.h"
+#include "lith/command.h"
+#include "lith/retained.h"
 
 #include <string>
 
@@ -23,9 +25,39 @@ public:
 	virtual void setPixelDensity(float density) = 0;
 	virtual void setCamera(const CameraLens& lens) = 0;
 
-	virtual void line(vec3 positionBegin, vec3 positionEnd, vec4 stroke) = 0;
+	// Clear to a color before drawing, what was drawn earlier in the frame is dropped
+	virtual void background(vec4 color) = 0;
+
+	// Keep what was drawn in the last frames instead of clearing the screen. Only what's drawn
+	// each frame is rendered, on top of an offscreen canvas, until background clears it.
+	virtual void setPersistentCanvas(bool persistent) = 0;
+
+	virtual void line(vec3 positionBegin, vec3 positionEnd, vec4 stroke, float strokeThickness, StrokeCap cap) = 0;
+
+	// Segments of a shape, see LineMesh::InstanceVertexData
+	virtual void lineSegments(const LineMesh::InstanceVertexData* segments, int count) = 0;
+
 	virtual void rect(vec2 position, vec2 size, float rotation, vec4 fill, vec4 stroke, float strokeThickness) = 0;
+
+	// Any kind of shape, see lith/shape.h
+	virtual void shape(const ShapeMesh::InstanceVertexData& shape) = 0;
+
+	// Triangles of a filled polygon, the indices are into 'vertices'
+	virtual void polygon(const PolygonMesh::VertexData* vertices, int vertexCount, const uint32_t* indices, int indexCount) = 0;
+
 	virtual void text(vec2 position, float size, TextMeshGenerationConfig alignment, const Font& font, const std::string& text) = 0;
+
+	// Meshes are drawn with depth testing before everything else
+	virtual void mesh(const CachedMesh& mesh, const MeshInstance& instance) = 0;
+
+	// Points from a cloud uploaded earlier, drawn after the meshes. The cloud must stay alive until the frame is drawn
+	virtual void pointCloud(const PointCloud& cloud, const Transform2D& transform) = 0;
+
+	// Geometry uploaded earlier, drawn after what's added each frame of the same kind. The shape must stay alive until the frame is drawn
+	virtual void retained(const RetainedShape& shape, const Transform2D& transform) = 0;
+
+	// Draw all the commands in a list, in the order they were recorded
+	virtual void submit(const RenderCommandList& commands) = 0;
 	
 	// put in sprite, should change it to use interface first
 };
\ No newline at end of file
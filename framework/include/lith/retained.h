@@ -0,0 +1,51 @@
+#pragma once
+
+#include "lith/command.h"
+
+// Retained shapes
+//	Draw calls recorded once into a command list, then uploaded into vertex arrays which are
+//	kept on the GPU. Drawing one is a draw call for each kind of geometry with its transform
+//	in the view matrix, so nothing is copied or uploaded each frame. Because the transform is
+//	applied on the GPU, shapes in a retained shape can be sheared as well.
+//
+//	Text, meshes, point clouds and other retained shapes aren't retained, they're kept in a
+//	command list and submitted each time the shape is drawn. A retained shape drawn into
+//	another is kept by pointer, so it has to outlive the shape it was drawn into. create throws
+//	if the shapes drawn into it draw it again, at any depth.
+//
+//	Must be created, updated and freed on the thread which owns the OpenGL context.
+
+class RetainedShape {
+public:
+	RetainedShape();
+
+	// Upload the geometry of the list, replacing what was uploaded before
+	void create(const RenderCommandList& commands);
+	void free();
+
+	// Replace part of the geometry, indexed like the vectors of the list it was created from.
+	// The ranges must be inside of what was created, the shape can't grow.
+	void updateLines(int first, const LineMesh::InstanceVertexData* segments, int count);
+	void updateShapes(int first, const ShapeMesh::InstanceVertexData* shapes, int count);
+	void updatePolygonVertices(int first, const PolygonMesh::VertexData* vertices, int count);
+
+	int getLineCount() const;
+	int getShapeCount() const;
+	int getPolygonVertexCount() const;
+
+	bool isCreated() const;
+
+public:
+	LineMesh lines;
+	ShapeMesh shapes;
+	PolygonMesh polygons;
+
+	// what isn't retained
+	RenderCommandList rest;
+
+private:
+	int lineCount;
+	int shapeCount;
+	int polygonVertexCount;
+	bool created;
+};
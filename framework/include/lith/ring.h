@@ -0,0 +1,180 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded lock-free queues
+//	mpsc_ring can be pushed to from any thread, and popped from a single consumer.
+//	Each slot has a sequence number which tells producers and the consumer whose
+//	turn it is, so a producer claims a slot with one CAS and publishes it with one store.
+//
+//	spsc_ring has a single producer and a single consumer. Each side only writes its own
+//	index and keeps a copy of the other's, which it reloads only when the ring looks full
+//	or empty, so most pushes and pops don't touch the other side's cache line.
+//
+//	_capacity must be a power of two.
+
+template<typename _t, size_t _capacity>
+class mpsc_ring {
+	static_assert((_capacity & (_capacity - 1)) == 0, "mpsc_ring capacity must be a power of two");
+
+public:
+	mpsc_ring() {
+		for (size_t i = 0; i < _capacity; i++) {
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	mpsc_ring(const mpsc_ring&) = delete;
+	mpsc_ring& operator=(const mpsc_ring&) = delete;
+
+	// Claim a slot and call write(_t&) on it in place, returns false if full
+	template<typename _write>
+	bool try_emplace(_write&& write) {
+		size_t pos = head.load(std::memory_order_relaxed);
+		Slot* slot;
+
+		while (true) {
+			slot = &slots[pos & mask];
+			size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+			if (diff == 0) {
+				if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			}
+
+			else if (diff < 0) {
+				return false;
+			}
+
+			else {
+				pos = head.load(std::memory_order_relaxed);
+			}
+		}
+
+		write(slot->item);
+		slot->sequence.store(pos + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	bool try_push(const _t& item) {
+		return try_emplace([&](_t& slot) { slot = item; });
+	}
+
+	// Call read(_t&) on the oldest item and release its slot, returns false if empty.
+	// Only one thread may pop.
+	template<typename _read>
+	bool try_consume(_read&& read) {
+		Slot& slot = slots[tail & mask];
+		size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+		if ((intptr_t)sequence - (intptr_t)(tail + 1) < 0) {
+			return false;
+		}
+
+		read(slot.item);
+		slot.sequence.store(tail + _capacity, std::memory_order_release);
+		tail += 1;
+
+		return true;
+	}
+
+	bool try_pop(_t& item) {
+		return try_consume([&](_t& slot) { item = slot; });
+	}
+
+	constexpr size_t capacity() const {
+		return _capacity;
+	}
+
+private:
+	static constexpr size_t mask = _capacity - 1;
+
+	struct Slot {
+		std::atomic<size_t> sequence;
+		_t item;
+	};
+
+	alignas(64) std::atomic<size_t> head = 0;
+	alignas(64) size_t tail = 0;
+	alignas(64) Slot slots[_capacity];
+};
+
+template<typename _t, size_t _capacity>
+class spsc_ring {
+	static_assert((_capacity & (_capacity - 1)) == 0, "spsc_ring capacity must be a power of two");
+
+public:
+	spsc_ring() = default;
+
+	spsc_ring(const spsc_ring&) = delete;
+	spsc_ring& operator=(const spsc_ring&) = delete;
+
+	// Only one thread may push, returns false if full
+	bool try_push(const _t& item) {
+		size_t pos = head.load(std::memory_order_relaxed);
+
+		if (pos - tailCache == _capacity) {
+			tailCache = tail.load(std::memory_order_acquire);
+
+			if (pos - tailCache == _capacity) {
+				return false;
+			}
+		}
+
+		slots[pos & mask] = item;
+		head.store(pos + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	// Call read(_t&) on the oldest item and release its slot, returns false if empty.
+	// Only one thread may pop.
+	template<typename _read>
+	bool try_consume(_read&& read) {
+		size_t pos = tail.load(std::memory_order_relaxed);
+
+		if (pos == headCache) {
+			headCache = head.load(std::memory_order_acquire);
+
+			if (pos == headCache) {
+				return false;
+			}
+		}
+
+		read(slots[pos & mask]);
+		tail.store(pos + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	bool try_pop(_t& item) {
+		return try_consume([&](_t& slot) { item = slot; });
+	}
+
+	// Exact on either side when the other isn't running
+	size_t size() const {
+		return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+	}
+
+	constexpr size_t capacity() const {
+		return _capacity;
+	}
+
+private:
+	static constexpr size_t mask = _capacity - 1;
+
+	// producer
+	alignas(64) std::atomic<size_t> head = 0;
+	size_t tailCache = 0;
+
+	// consumer
+	alignas(64) std::atomic<size_t> tail = 0;
+	size_t headCache = 0;
+
+	alignas(64) _t slots[_capacity];
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "lith/mesh.h"
+#include "lith/shader.h"
+#include "lith/cull.h"
+
+// Every shape is drawn from the same instance stream by one program, which picks
+// the distance function by the kind. The stroke is drawn inside of the edge.
+enum ShapeKind {
+	ShapeRect,    // params.x is the corner radius
+	ShapeEllipse, // inscribed in the rect
+	ShapeArc,     // ellipse cut to the angles from params.x to params.y, as a pie
+	ShapeTriangle // corners at position, position + params.xy and position + params.zw, size is unused
+};
+
+class ShapeMesh {
+public:
+	// 52 bytes, see packColor and packHalf
+	struct InstanceVertexData {
+		vec3 pos; // 0
+		vec2 scale; // 12
+		float rotation; // 20
+		vec4 params; // 24
+		uint32_t strokeColor; // 40, RGBA8
+		uint32_t fillColor; // 44, RGBA8
+		uint16_t strokeThickness; // 48, half
+		uint8_t kind; // 50
+	};
+
+	struct QuadVertexData {
+		vec2 pos;
+	};
+
+	void create();
+	void free();
+	void draw();
+	void clear();
+
+	void addShape(const InstanceVertexData& shape);
+	void addShapes(const InstanceVertexData* shapes, int count);
+
+	// Drop the shapes outside of the view before they're uploaded. Rotated shapes are boxed
+	// by the circle they turn in
+	CullStats cull(const ViewBounds& view, float pixelSize);
+
+	// Retained meshes are uploaded once and drawn as they are, parts can be replaced after
+	void upload();
+	void drawUploaded() const;
+	void setShapes(int first, const InstanceVertexData* shapes, int count);
+
+private:
+	VertexArray mesh;
+	VertexBuffer* instances;
+	CullBoxes boxes;
+};
+
+ShapeMesh::InstanceVertexData makeShape(ShapeKind kind, vec2 xy, vec2 wh, float rotation, vec4 params, vec4 fill, vec4 stroke, float strokeThickness);
+
+class ShapeProgram {
+public:
+	void create();
+	void free();
+
+	// 'pixelSize' is the size of a pixel in world units, the quads are padded by it for the anti-aliased edge
+	void use(const mat4& view, const mat4& proj, float pixelSize);
+
+private:
+	ShaderProgram program;
+};
+
+class ShapeRenderer {
+public:
+	void create();
+	void free();
+	void draw(const mat4& view, const mat4& proj, float pixelSize);
+	void clear();
+
+	void addRect(vec2 xy, vec2 wh, float rotation, vec4 fill, vec4 stroke, float strokeThickness);
+	void addShape(const ShapeMesh::InstanceVertexData& shape);
+	void addShapes(const ShapeMesh::InstanceVertexData* shapes, int count);
+
+	// Draw a retained mesh with this renderer's program
+	void drawMesh(const ShapeMesh& mesh, const mat4& view, const mat4& proj, float pixelSize);
+
+	// How many shapes were drawn last time out of how many were added
+	const CullStats& stats() const;
+
+private:
+	ShapeProgram shader;
+	ShapeMesh mesh;
+
+	CullStats lastStats = {};
+};
@@ -15,12 +15,14 @@ CR_EXPORT int cr_main(cr_plugin* plugin, cr_op operation) {
             // This HAS to be done first because it connects the logger
             __setContext(sketch, context->app);
             setup();
+            __restoreState();
 
             print("Sketch loaded");
             break;
 
         case CR_STEP: 
             if (__nextFrame()) {
+                LITH_PROFILE_SCOPE("draw");
                 draw();
                 __endFrame();
             }
@@ -28,6 +30,7 @@ CR_EXPORT int cr_main(cr_plugin* plugin, cr_op operation) {
             break;
 
         case CR_UNLOAD:
+            __saveState();
             print("Sketch unloaded");
             break;
 
@@ -3,6 +3,8 @@
 #include "lith/context.h"
 #include "lith/log.h"
 
+#include <type_traits>
+
 // the public api should match processing as close as possible
 
 extern float mouseX;
@@ -23,6 +25,13 @@ extern float height;
 extern float deltaTime;
 extern float totalTime;
 
+// set while inside of the fixed update callback
+extern float fixedDeltaTime;
+
+// how far between the last and next fixed update draw is being called, [0, 1)
+// use to interpolate state which is only updated in the fixed update
+extern float fixedAlpha;
+
 extern void setup();
 extern void draw();
 
@@ -35,14 +44,41 @@ void noLoop();
 void loop();
 void fps(int framelimit);
 
+// Call 'update' at a fixed rate, before draw, as many times as the
+// elapsed time requires. Pass nullptr to stop, the rate must be above 0
+void fixedUpdate(void (*update)(), int rate = 60);
+
+lithFrameStats frameStats();
+
+void __keep(const char* name, void* value, size_t size);
+
+// Keep the value of a global when the sketch is hot reloaded. Call in setup, the value saved
+// when the last version was unloaded is copied back after setup returns. Values are matched
+// by name and size, so one which changed type starts from what setup gives it
+template<typename _t>
+void keep(const char* name, _t& value) {
+	static_assert(std::is_trivially_copyable_v<_t>, "Only trivially copyable values can be kept across reloads");
+	__keep(name, &value, sizeof(_t));
+}
+
 float millis();
 
 void camera(const CameraLens& lens);
 
+// Clears what's been drawn, including earlier in this frame. Call on the main thread,
+// it can't be recorded into a command list
 void background(int rgb);
 void background(int r, int g, int b);
 
+// Keep what was drawn between frames, like processing when draw doesn't call background.
+// Only the shapes drawn each frame are rendered, on top of an offscreen canvas which is
+// copied to the screen. It's kept when the window is resized, and when the sketch reloads
+// if setup turns it on again.
+void persistentCanvas(bool enabled = true);
+
 void strokeWeight(float weight);
+void strokeCap(StrokeCap cap);
+void strokeJoin(StrokeJoin join);
 
 void noStroke();
 void stroke(float rgb, float a = 255);
@@ -56,18 +92,132 @@ void textFont(const Font& font);
 void textSize(float size);
 void textAlign(TextAlign alignX, TextAlign alignY = TextAlignBaseline);
 
+// The transform applied to everything drawn, reset at the start of each frame. Each call
+// applies before the ones already made, like in processing. Shapes are transformed on the
+// CPU as they're handed to the renderer, see lith/transform.h for what can't be exact.
+void pushMatrix();
+void popMatrix();
+void resetMatrix();
+void translate(float x, float y);
+void translate(vec2 offset);
+void rotate(float angle);
+void scale(float scale);
+void scale(float x, float y);
+void applyMatrix(const Transform2D& transform);
+const Transform2D& getMatrix();
+
+// A dot the size of the stroke weight, in the stroke color
+void point(float x, float y);
+void point(vec2 position);
+
 void line(float x1, float y1, float x2, float y2);
 void line(float x1, float y1, float z1, float x2, float y2, float z2);
 void line(vec2 start, vec2 end);
 void line(vec3 start, vec3 end);
 
+// Draw a shape through the vertices. The outline is drawn with the stroke and joins, its segments
+// are streamed to the renderer as the vertices are added, so shapes can have any number of them.
+// The inside is filled by tessellating it, which is cached by the points, so shapes which don't
+// change are only tessellated once. Fill is on by default, call noFill() for open lines, most of
+// all ones whose points change each frame, which would be tessellated every frame. Shapes with
+// more than 16384 points aren't filled. Can be used inside drawParallel, which tessellates on
+// the job threads.
+void beginShape();
+void vertex(float x, float y);
+void vertex(float x, float y, float z);
+void vertex(vec2 position);
+void vertex(vec3 position);
+void endShape(bool close = false);
+
+// Cut a hole in the shape, call after the vertices of the outline
+void beginContour();
+void endContour();
+
+// Curves are flattened into vertices of the shape, with segments small enough that
+// they're within a quarter of a pixel of the curve under the current camera
+
+// A cubic bezier from the last vertex to 'end', bent by the two control points
+void bezierVertex(float cx1, float cy1, float cx2, float cy2, float x, float y);
+void bezierVertex(vec2 control1, vec2 control2, vec2 end);
+
+// A Catmull-Rom spline through the vertices, the first and last only shape the ends
+void curveVertex(float x, float y);
+void curveVertex(vec2 position);
+
+void bezier(float x1, float y1, float cx1, float cy1, float cx2, float cy2, float x2, float y2);
+void bezier(vec2 start, vec2 control1, vec2 control2, vec2 end);
+
+// The spline from b to c, a and d shape the tangents
+void curve(float ax, float ay, float bx, float by, float cx, float cy, float dx, float dy);
+void curve(vec2 a, vec2 b, vec2 c, vec2 d);
+
+// Shapes are drawn with the fill, and the stroke inside of their edge
+
 void rect(float x, float y, float width, float height);
-void rect(vec2 base, vec2 size);
+void rect(float x, float y, float width, float height, float radius);
+void rect(vec2 base, vec2 size, float radius = 0.f);
+
+// Centered on the position
+void ellipse(float x, float y, float width, float height);
+void ellipse(vec2 center, vec2 size);
+void circle(float x, float y, float diameter);
+
+// A pie cut from the ellipse, between the angles in radians going from +x towards +y.
+// Nothing is drawn if stop is less than start
+void arc(float x, float y, float width, float height, float start, float stop);
+
+void triangle(float x1, float y1, float x2, float y2, float x3, float y3);
+void triangle(vec2 a, vec2 b, vec2 c);
 
 void sprite(const TextureInterface& texture, float x, float y, float width, float height);
 
 void text(const std::string& text, float x, float y);
 
+// Meshes use the fill color and are drawn with depth testing, underneath the 2D shapes.
+// Set a perspective camera to see them in 3D.
+
+// Subdivisions of the sphere mesh, defaults to 3. Call on the main thread
+void sphereDetail(int resolution);
+
+void box(float x, float y, float z, float size);
+void box(vec3 position, vec3 size, quat rotation = quat(1, 0, 0, 0));
+
+void sphere(float x, float y, float z, float radius);
+void sphere(vec3 position, float radius);
+
+// Draw a mesh from the mesh cache, see lith/meshcache.h
+void mesh(const CachedMesh& mesh, vec3 position, vec3 scale = vec3(1), quat rotation = quat(1, 0, 0, 0));
+
+// Point clouds are for drawing millions of points, see lith/pointcloud.h. The points are uploaded
+// once with appendPoints and only the ones the camera needs are drawn, with their own size and
+// color. Create the cloud and append to it on the main thread, it must outlive the frame.
+void appendPoints(PointCloud& cloud, const PointVertex* points, int count);
+void points(const PointCloud& cloud);
+
+// Record the draw calls made on this thread into 'list' instead of drawing them.
+// This can be used on any thread, but only the draw and style functions can be called
+// until endCommands. Can be nested, endCommands records into the outer list again.
+void beginCommands(RenderCommandList& list);
+void endCommands();
+
+// Draw a recorded list, call on the main thread. The list is drawn with the current matrix
+// applied, so one list can be recorded and drawn in many places.
+void submitCommands(const RenderCommandList& list);
+
+// Record the draw calls between beginRetained and endRetained once, and keep them uploaded in
+// 'shape', see lith/retained.h. They're recorded without the current matrix, drawRetained applies
+// it, so drawing the shape each frame costs a few draw calls and no uploads. Parts of it can
+// be changed later with the update functions of the shape. Record on the main thread, one
+// shape at a time, beginRetained throws if another shape is being recorded.
+void beginRetained(RetainedShape& shape);
+void endRetained();
+void drawRetained(const RetainedShape& shape);
+
+// Call 'perItem' for each index in [0, count) on the job threads. Draw calls inside are
+// recorded and drawn in index order, so the result is the same as a loop on the main thread.
+// Only the draw and style functions can be called inside of 'perItem'.
+void drawParallel(int count, const std::function<void(int)>& perItem);
+
 void playSound(Audio& audio);
 void playMusic(Audio& audio);
 
@@ -84,4 +234,6 @@ AxisGroupBuilder createAxisGroup(const InputName& name);
 
 void __setContext(SketchContext* ctx, AppContext* app);
 bool __nextFrame();
-void __endFrame();
\ No newline at end of file
+void __endFrame();
+void __saveState();
+void __restoreState();
\ No newline at end of file
@@ -48,6 +48,13 @@ public:
 	// Return the texture linked for an attachment, or nullptr if one does not exist.
 	TextureInterface* get(TargetAttachmentType attachment);
 
+	int getWidth() const;
+	int getHeight() const;
+
+	// Copy the color attachments into another target, or the screen if it's null. The bottom left
+	// corners line up and what doesn't fit is cut off. Leaves the destination in use.
+	void blit(Target* destination, int width, int height);
+
 	void upload();
 	void download();
 	void free();
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "lith/math.h"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+// Polygon tessellation
+//	Fills an outline with holes by ear clipping, after earcut by Mapbox. The holes are joined to the
+//	outline by bridges first, so the whole polygon is clipped as one. Concave and touching outlines
+//	work; self intersecting ones are split as well as they can be.
+//
+//	Outlines are given as points, with the end of each contour. The first contour is the outline and
+//	the others are holes, their winding doesn't matter.
+
+// Append the triangles as indices into 'points', returns false if nothing could be filled
+bool tessellatePolygon(const vec2* points, const int* contourEnds, int contourCount, std::vector<uint32_t>& indices);
+
+// Tessellations of the polygons drawn in the last frames, keyed by a hash of their points.
+// Each entry keeps its points, so polygons which share a hash are told apart.
+// Thread safe, so shapes can be tessellated on the job threads.
+class PolygonCache {
+public:
+	using Indices = std::shared_ptr<const std::vector<uint32_t>>;
+
+	// Find the triangles of a polygon, or tessellate it the first time it's seen
+	Indices get(const vec2* points, const int* contourEnds, int contourCount);
+
+	// Drop the polygons which weren't used since the last tick, call once a frame
+	void tick();
+
+	int size();
+
+private:
+	struct Entry {
+		Indices indices;
+		std::vector<vec2> points;
+		std::vector<int> contourEnds;
+		bool used;
+
+		bool matches(const vec2* points, const int* contourEnds, int contourCount) const;
+	};
+
+	std::mutex mutex;
+	std::unordered_map<uint64_t, Entry> entries;
+};
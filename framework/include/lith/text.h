@@ -4,6 +4,9 @@
 #include "lith/mesh.h"
 #include "lith/shader.h"
 #include "lith/texture.h"
+#include "lith/cull.h"
+
+#include <cfloat>
 
 enum TextAlign {
 	// horizontal alignment
@@ -45,9 +48,16 @@ public:
 
 	void setPixelPerfect(bool pixelPerfect);
 
+	// The box around the glyphs, min is larger than max when there are none
+	vec2 getMin() const;
+	vec2 getMax() const;
+
 private:
 	VertexArray mesh;
 	bool isPixelPerfect = false;
+
+	vec2 posMin = vec2(FLT_MAX);
+	vec2 posMax = vec2(-FLT_MAX);
 };
 
 class TextProgram {
@@ -76,6 +86,9 @@ public:
 	// maybe this is fine
 	void addString(vec2 textPosition, float textSize, const TextureInterface* fontTexture, const TextMesh& mesh);
 
+	// How many strings were drawn last time out of how many were added
+	const CullStats& stats() const;
+
 private:
 	struct TextMeshInstance {
 		const TextureInterface* font;
@@ -87,4 +100,8 @@ private:
 	TextProgram shader;
 
 	std::vector<TextMeshInstance> instances;
+
+	// strings outside of the view aren't uploaded or drawn
+	CullBoxes boxes;
+	CullStats lastStats = {};
 };
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "lith/math.h"
+#include "lith/line.h"
+#include "lith/shape.h"
+#include "lith/polygon.h"
+#include "lith/meshrender.h"
+
+class RenderCommandList;
+
+// A 2D affine transform, stored as the two columns of its linear part and the translation.
+// Transforms multiply like matrices, 'a * b' applies b first.
+struct Transform2D {
+	vec2 axisX = vec2(1, 0);
+	vec2 axisY = vec2(0, 1);
+	vec2 origin = vec2(0, 0);
+
+	vec2 apply(vec2 point) const { return axisX * point.x + axisY * point.y + origin; }
+	vec2 applyVector(vec2 vector) const { return axisX * vector.x + axisY * vector.y; }
+
+	Transform2D operator*(const Transform2D& other) const;
+
+	bool isIdentity() const;
+
+	// As a model matrix, leaving z alone
+	mat4 matrix() const;
+
+	// How much areas are scaled by, as a length. Stroke weights are scaled by this
+	float scaleFactor() const;
+
+	static Transform2D translation(vec2 offset);
+	static Transform2D rotation(float angle);
+	static Transform2D scaling(vec2 scale);
+};
+
+// The transform as a rotation after a scale along the axes, the shear is dropped
+struct Transform2DParts {
+	float rotation;
+	vec2 scale; // y is negative if the transform mirrors
+};
+
+Transform2DParts decompose(const Transform2D& transform);
+
+// Batch transforms of the instance data the renderers take, in place. The transform is split up
+// once for the batch, so each item is a couple of multiply adds.
+//
+// Lines and polygons are exact. Shapes are drawn by their distance functions, which can't
+// be sheared, so they're rotated and scaled by the decomposed transform, which is exact
+// unless the transform is sheared or scales a rotated shape unevenly. Triangles are exact.
+// Text is only moved and sized, and meshes are turned around z. Point clouds and retained
+// shapes keep their transform, it's applied on the GPU.
+
+void transformLineSegments(const Transform2D& transform, LineMesh::InstanceVertexData* segments, int count);
+void transformShapes(const Transform2D& transform, ShapeMesh::InstanceVertexData* shapes, int count);
+void transformPolygonVertices(const Transform2D& transform, PolygonMesh::VertexData* vertices, int count);
+void transformMeshInstances(const Transform2D& transform, MeshInstance* instances, int count);
+
+// Every command in the list
+void transformCommands(const Transform2D& transform, RenderCommandList& commands);
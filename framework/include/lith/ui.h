@@ -1,6 +1,21 @@
 #pragma once
 
-#include <unordered_map>
+#include "lith/command.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Immediate mode UI
+//	Widgets are called every frame, and find their state from the last frame by an id hashed
+//	from their key and the id stack. Their rects and labels are recorded into one command list,
+//	which lithTickUI submits at the end of the frame, so a panel of thousands of widgets is one
+//	batch of rects. Labels are only formatted again when their value changes, so the text mesh
+//	cache finds the same string.
+//
+//	Widgets must be called on the main thread.
+
+using UIID = uint64_t;
 
 struct SliderData {
 	float x;
@@ -15,7 +30,7 @@ struct SliderData {
 	float grabWidthVelocityMod = .5f;
 	float grabMinWidth = .06f;
 	float grabMaxWidth = .8f;
-	
+
 	bool isDragging = false;
 	float dragOffsetX = 0.f;
 	float velocity = 0.f;
@@ -24,16 +39,121 @@ struct SliderData {
 	float maxValue;
 
 	int lastFrameUsed;
+
+	// the value and format 'label' was formatted from
+	float labelValue = 0.f;
+	const char* labelFormat = nullptr;
+	std::string label;
+};
+
+// Open addressing with linear probing. Nothing is erased, when the table fills up it's
+// rebuilt with only the entries used in the last frame, so dropping unused widgets is
+// paid for by the inserts instead of a walk every frame.
+template<typename _t>
+class UITable {
+public:
+	// Find the entry of 'id', or insert a default one. The reference is valid until the next call
+	_t& get(UIID id, int frame) {
+		if ((count + 1) * 4 > (int)slots.size() * 3) {
+			rebuild(frame);
+		}
+
+		size_t mask = slots.size() - 1;
+		size_t index = id & mask;
+
+		while (slots[index].id != id) {
+			if (slots[index].id == 0) {
+				slots[index].id = id;
+				slots[index].value = {};
+				count += 1;
+				break;
+			}
+
+			index = (index + 1) & mask;
+		}
+
+		return slots[index].value;
+	}
+
+	int size() const {
+		return count;
+	}
+
+private:
+	void rebuild(int frame) {
+		std::vector<Slot> old;
+		old.swap(slots);
+
+		int live = 0;
+		for (const Slot& slot : old) {
+			if (slot.id != 0 && slot.value.lastFrameUsed >= frame - 1) {
+				live += 1;
+			}
+		}
+
+		// stay under half full after the rebuild, so it isn't needed again soon
+		size_t capacity = 16;
+		while (capacity < (size_t)(live + 1) * 2) {
+			capacity *= 2;
+		}
+
+		slots.resize(capacity);
+		count = 0;
+
+		size_t mask = capacity - 1;
+
+		for (Slot& slot : old) {
+			if (slot.id == 0 || slot.value.lastFrameUsed < frame - 1) {
+				continue;
+			}
+
+			size_t index = slot.id & mask;
+			while (slots[index].id != 0) {
+				index = (index + 1) & mask;
+			}
+
+			slots[index].id = slot.id;
+			slots[index].value = std::move(slot.value);
+			count += 1;
+		}
+	}
+
+	struct Slot {
+		UIID id = 0; // 0 is empty
+		_t value;
+	};
+
+	std::vector<Slot> slots;
+	int count = 0;
 };
 
 struct UIContext {
-	std::unordered_map<void*, SliderData> sliders;
+	UITable<SliderData> sliders;
+
+	// seeds of the ids, the bottom is 0
+	std::vector<UIID> idStack;
+
+	// widgets of this frame, submitted by lithTickUI
+	RenderCommandList commands;
+
 	int frame = 0;
 };
 
 void registerUIContext(UIContext* context);
+
+// Submit the widgets of this frame, called by the sketch after draw
 void lithTickUI();
 
+// Scope the ids of the widgets until popID, so the same keys can be used in different places,
+// for example in a loop which draws a panel for each item
+void pushID(const char* name);
+void pushID(const void* pointer);
+void pushID(int index);
+void popID();
+
+UIID uiID(const char* name);
+UIID uiID(const void* pointer);
+
 bool isRectHovered(float x, float y, float width, float height);
 
 bool slider(float* value, float min, float max, float x, float y, float length);
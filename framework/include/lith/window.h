@@ -11,7 +11,8 @@ public:
 	virtual void swapBuffers() = 0;
 	virtual void makeCurrent() = 0;
 
-	virtual void pollEvents(EventPipe* events) = 0;
+	// Push the window's events since the last poll, and flush
+	virtual void pollEvents(EventRing* events) = 0;
 
 	virtual void setTitle(const char* name) = 0;
 	virtual void setWindowSize(int width, int height) = 0;
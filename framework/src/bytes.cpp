@@ -19,6 +19,10 @@ void ByteVector::clear() {
 	raw = {};
 }
 
+void ByteVector::resize(int count) {
+	raw.resize(count * itemSize);
+}
+
 int ByteVector::size() const {
 	return (int)raw.size();
 }
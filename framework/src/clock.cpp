@@ -1,9 +1,13 @@
 #include "lith/clock.h"
 #include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cmath>
 
 using lithclock = std::chrono::high_resolution_clock;
 using lithtimepoint = std::chrono::time_point<lithclock >;
 using lithduration = lithclock::duration;
+using lithseconds = std::chrono::duration<double>;
 
 static lithtimepoint chrono_start = lithclock::now();
 static lithtimepoint chrono_now = lithclock::now();
@@ -21,6 +25,27 @@ static float current_delta = 0.0f;
 static float current_delta_scaled = 0.0f;
 static float current_fixed_scaled = 0.0f;
 
+// frame pacing
+
+static lithduration  frame_target = lithduration::zero();
+static lithtimepoint frame_next = lithclock::now();
+static float frame_limit = 0.0f;
+
+// Moving mean and variance of how long a 1ms sleep really takes, the
+// spin starts when less than (mean + stddev) is left. This adapts to the
+// timer resolution of the OS instead of hardcoding a spin window. Old
+// samples fade out, so the estimate follows changes in load.
+
+static const double sleep_weight = 0.05;
+
+static double sleep_estimate = 0.005;
+static double sleep_mean = 0.001;
+static double sleep_variance = 0.0;
+
+static float frame_times[lithFrameStatsCount] = {};
+static int frame_times_count = 0;
+static int frame_times_next = 0;
+
 float lithDeltaTime() {
 	return current_delta_scaled;
 }
@@ -30,7 +55,8 @@ float lithTotalTime() {
 }
 
 float lithGetTime() {
-    return lithclock::now().time_since_epoch().count() / 1000000000.0f;
+	// relative to startup, seconds since epoch don't fit in a float
+	return lithseconds(lithclock::now() - chrono_start).count();
 }
 
 void lithUpdateTime() {
@@ -45,4 +71,86 @@ void lithUpdateTime() {
 
     chrono_delta = lithclock::now() - chrono_now;
     chrono_now = lithclock::now();
-}
\ No newline at end of file
+
+	if (current_delta > 0.0f) {
+		frame_times[frame_times_next] = current_delta;
+		frame_times_next = (frame_times_next + 1) % lithFrameStatsCount;
+		frame_times_count = std::min(frame_times_count + 1, lithFrameStatsCount);
+	}
+}
+
+static void sleepUntil(lithtimepoint until) {
+	while (true) {
+		lithtimepoint start = lithclock::now();
+
+		if (lithseconds(until - start).count() <= sleep_estimate) {
+			break;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		double observed = lithseconds(lithclock::now() - start).count();
+
+		double delta = observed - sleep_mean;
+		sleep_mean += sleep_weight * delta;
+		sleep_variance = (1.0 - sleep_weight) * (sleep_variance + sleep_weight * delta * delta);
+
+		sleep_estimate = sleep_mean + std::sqrt(sleep_variance);
+	}
+
+	while (lithclock::now() < until) {
+		std::this_thread::yield();
+	}
+}
+
+void lithSetFrameLimit(float framesPerSecond) {
+	frame_limit = framesPerSecond;
+
+	frame_target = framesPerSecond > 0.0f
+		? std::chrono::duration_cast<lithduration>(lithseconds(1.0 / framesPerSecond))
+		: lithduration::zero();
+
+	frame_next = lithclock::now();
+}
+
+float lithGetFrameLimit() {
+	return frame_limit;
+}
+
+void lithWaitForFrame() {
+	if (frame_target == lithduration::zero()) {
+		return;
+	}
+
+	frame_next += frame_target;
+
+	// if more than a frame behind, don't try and catch up by
+	// running the next frames without waiting
+	lithtimepoint now = lithclock::now();
+	if (frame_next < now) {
+		frame_next = now;
+		return;
+	}
+
+	sleepUntil(frame_next);
+}
+
+lithFrameStats lithGetFrameStats() {
+	lithFrameStats stats = {};
+	stats.count = frame_times_count;
+
+	if (frame_times_count == 0) {
+		return stats;
+	}
+
+	float sorted[lithFrameStatsCount];
+	std::copy(frame_times, frame_times + frame_times_count, sorted);
+	std::sort(sorted, sorted + frame_times_count);
+
+	int last = frame_times_count - 1;
+	stats.p50 = sorted[last / 2];
+	stats.p99 = sorted[(int)(last * 0.99f)];
+	stats.max = sorted[last];
+
+	return stats;
+}
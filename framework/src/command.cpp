@@ -0,0 +1,67 @@
+#include "lith/command.h"
+
+void RenderCommandList::line(vec3 positionBegin, vec3 positionEnd, vec4 stroke, float strokeThickness, StrokeCap cap) {
+	lines.push_back(makeLineSegment(positionBegin, positionEnd, vec2(positionBegin), vec2(positionEnd), stroke, strokeThickness, cap, StrokeJoinMiter));
+}
+
+void RenderCommandList::lineSegments(const LineMesh::InstanceVertexData* segments, int count) {
+	lines.insert(lines.end(), segments, segments + count);
+}
+
+void RenderCommandList::rect(vec2 position, vec2 size, float rotation, vec4 fill, vec4 stroke, float strokeThickness) {
+	shapes.push_back(makeShape(ShapeRect, position, size, rotation, vec4(0), fill, stroke, strokeThickness));
+}
+
+void RenderCommandList::shape(const ShapeMesh::InstanceVertexData& shape) {
+	shapes.push_back(shape);
+}
+
+void RenderCommandList::polygon(const PolygonMesh::VertexData* vertices, int vertexCount, const uint32_t* indices, int indexCount) {
+	uint32_t base = (uint32_t)polygonVertices.size();
+	polygonVertices.insert(polygonVertices.end(), vertices, vertices + vertexCount);
+
+	for (int i = 0; i < indexCount; i++) {
+		polygonIndices.push_back(base + indices[i]);
+	}
+}
+
+void RenderCommandList::text(vec2 position, float size, TextMeshGenerationConfig config, const Font& font, const std::string& text) {
+	texts.push_back({ position, size, config, &font, text });
+}
+
+void RenderCommandList::mesh(const CachedMesh& mesh, const MeshInstance& instance) {
+	meshes.push_back({ &mesh, instance });
+}
+
+void RenderCommandList::pointCloud(const PointCloud& cloud, const Transform2D& transform) {
+	pointClouds.push_back({ &cloud, transform });
+}
+
+void RenderCommandList::retained(const RetainedShape& shape, const Transform2D& transform) {
+	retainedShapes.push_back({ &shape, transform });
+}
+
+void RenderCommandList::append(const RenderCommandList& list) {
+	lines.insert(lines.end(), list.lines.begin(), list.lines.end());
+	shapes.insert(shapes.end(), list.shapes.begin(), list.shapes.end());
+	polygon(list.polygonVertices.data(), (int)list.polygonVertices.size(), list.polygonIndices.data(), (int)list.polygonIndices.size());
+	texts.insert(texts.end(), list.texts.begin(), list.texts.end());
+	meshes.insert(meshes.end(), list.meshes.begin(), list.meshes.end());
+	pointClouds.insert(pointClouds.end(), list.pointClouds.begin(), list.pointClouds.end());
+	retainedShapes.insert(retainedShapes.end(), list.retainedShapes.begin(), list.retainedShapes.end());
+}
+
+void RenderCommandList::clear() {
+	lines.clear();
+	shapes.clear();
+	polygonVertices.clear();
+	polygonIndices.clear();
+	texts.clear();
+	meshes.clear();
+	pointClouds.clear();
+	retainedShapes.clear();
+}
+
+bool RenderCommandList::empty() const {
+	return lines.empty() && shapes.empty() && polygonIndices.empty() && texts.empty() && meshes.empty() && pointClouds.empty() && retainedShapes.empty();
+}
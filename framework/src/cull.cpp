@@ -0,0 +1,92 @@
+#include "lith/cull.h"
+
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+
+ViewBounds getViewBounds(const mat4& viewProj) {
+	mat4 inverseViewProj = inverse(viewProj);
+
+	ViewBounds bounds = { vec2(FLT_MAX), vec2(-FLT_MAX) };
+
+	for (int i = 0; i < 8; i++) {
+		vec4 corner = vec4(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f, 1.f);
+		vec4 world = inverseViewProj * corner;
+
+		if (world.w <= 1e-6f || !std::isfinite(world.x / world.w) || !std::isfinite(world.y / world.w)) {
+			return { vec2(-FLT_MAX), vec2(FLT_MAX) };
+		}
+
+		vec2 point = vec2(world) / world.w;
+		bounds.min = min(bounds.min, point);
+		bounds.max = max(bounds.max, point);
+	}
+
+	return bounds;
+}
+
+void CullBoxes::resize(int count) {
+	minX.resize(count);
+	minY.resize(count);
+	maxX.resize(count);
+	maxY.resize(count);
+	visible.resize(count);
+}
+
+void CullBoxes::set(int index, vec2 min, vec2 max) {
+	minX[index] = min.x;
+	minY[index] = min.y;
+	maxX[index] = max.x;
+	maxY[index] = max.y;
+}
+
+int CullBoxes::cull(const ViewBounds& view) {
+	const float viewMinX = view.min.x;
+	const float viewMinY = view.min.y;
+	const float viewMaxX = view.max.x;
+	const float viewMaxY = view.max.y;
+
+	const float* x0 = minX.data();
+	const float* y0 = minY.data();
+	const float* x1 = maxX.data();
+	const float* y1 = maxY.data();
+	uint8_t* out = visible.data();
+
+	int count = (int)visible.size();
+	int visibleCount = 0;
+
+	// no branches so it vectorizes
+	for (int i = 0; i < count; i++) {
+		uint8_t inside = (uint8_t)((x0[i] <= viewMaxX) & (x1[i] >= viewMinX) & (y0[i] <= viewMaxY) & (y1[i] >= viewMinY));
+		out[i] = inside;
+		visibleCount += inside;
+	}
+
+	return visibleCount;
+}
+
+void keepVisible(ByteVector& items, const uint8_t* visible, int visibleCount) {
+	int count = items.count();
+
+	if (visibleCount == count) {
+		return;
+	}
+
+	int stride = items.stride();
+	char* data = (char*)items.data();
+
+	int kept = 0;
+	for (int i = 0; i < count; i++) {
+		if (!visible[i]) {
+			continue;
+		}
+
+		if (kept != i) {
+			memcpy(data + kept * stride, data + i * stride, stride);
+		}
+
+		kept++;
+	}
+
+	items.resize(visibleCount);
+}
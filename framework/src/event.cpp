@@ -0,0 +1,45 @@
+#include "lith/event.h"
+
+static bool isMotion(const lithEvent& event) {
+	return event.type == lithMouse && event.mouse.mousecode == MOUSE_VEL_POS;
+}
+
+bool EventRing::push(const lithEvent& event) {
+	if (isMotion(event)) {
+		if (hasMotion) {
+			float vel_x = motion.mouse.vel_x + event.mouse.vel_x;
+			float vel_y = motion.mouse.vel_y + event.mouse.vel_y;
+
+			motion = event;
+			motion.mouse.vel_x = vel_x;
+			motion.mouse.vel_y = vel_y;
+		}
+
+		else {
+			motion = event;
+			hasMotion = true;
+		}
+
+		return true;
+	}
+
+	if (!flush()) {
+		return false;
+	}
+
+	return ring.try_push(event);
+}
+
+bool EventRing::flush() {
+	if (!hasMotion) {
+		return true;
+	}
+
+	// keep holding it if full, the next flush tries again
+	if (!ring.try_push(motion)) {
+		return false;
+	}
+
+	hasMotion = false;
+	return true;
+}
@@ -315,6 +315,7 @@ void FontTextMeshCache::clear() {
         it->second.keepAliveFrameCount -= 1;
         
         if (it->second.keepAliveFrameCount <= 0) {
+            it->second.mesh.free();
             it = strings.erase(it);
         }
 
@@ -1,5 +1,6 @@
 #include "lith/icosphere.h"
-#include <unordered_map>
+#include "lith/job.h"
+#include <algorithm>
 
 static const float Z = (1.0f + sqrt(5.0f)) / 2.0f; // Golden ratio
 static const vec2 UV = vec2(1 / 11.0f, 1 / 3.0f); // The UV coordinates are laid out in a 11x3 grid
@@ -66,106 +67,265 @@ static const int IcoIndex[] = {
 	15, 17, 19
 };
 
-Icosphere MakeIcosphere(int resolution) {
-	// For each resolution, every triangle is subdivided and replaced with 4 new triangles.
-	// Most of the vertices are shared between triangles, so an index is also generated.
-	// The number of vertices and indices for a given resolution can be calculated by using a geometric series.
-	//
-	// Example:
-	// 
-	//     *-------*               *---*---*
-	//    / \     /               / \ / \ /
-	//   /   \   /	  ------->   *---*---*
-	//  /     \ /               / \ / \ /
-	// *-------*               *---*---*
- 
-	const int rn = (int)pow(4, resolution);
-	const int totalIndexCount = IcoIndexCount * rn;
-	const int totalVertexCount = IcoVertexCount + IcoIndexCount * (1 - rn) / (1 - 4);
+static const int IcoFaceCount = IcoIndexCount / 3;
 
-	Icosphere sphere;
+// The edges of the base mesh, found once by sorting the 60 half edges. Vertices
+// which share a position but not an index (the uv seam) have separate edges, same
+// as the faces which use them.
+
+struct IcoEdgeTable {
+	int edgeCount = 0;
+	int faceEdge[IcoFaceCount][3];
+	bool faceEdgeReversed[IcoFaceCount][3]; // the edge goes from its higher to lower index
+
+	IcoEdgeTable() {
+		struct HalfEdge {
+			int low;
+			int high;
+			int face;
+			int edge;
+		};
+
+		HalfEdge halfEdges[IcoIndexCount];
+
+		for (int f = 0; f < IcoFaceCount; f++) {
+			for (int e = 0; e < 3; e++) {
+				int first = IcoIndex[f * 3 + e];
+				int second = IcoIndex[f * 3 + (e + 1) % 3];
+
+				halfEdges[f * 3 + e] = { std::min(first, second), std::max(first, second), f, e };
+				faceEdgeReversed[f][e] = first > second;
+			}
+		}
+
+		std::sort(halfEdges, halfEdges + IcoIndexCount, [](const HalfEdge& a, const HalfEdge& b) {
+			return a.low != b.low ? a.low < b.low : a.high < b.high;
+		});
+
+		for (int i = 0; i < IcoIndexCount; i++) {
+			const HalfEdge& half = halfEdges[i];
+
+			if (i > 0 && half.low == halfEdges[i - 1].low && half.high == halfEdges[i - 1].high) {
+				faceEdge[half.face][half.edge] = edgeCount - 1;
+			}
+
+			else {
+				faceEdge[half.face][half.edge] = edgeCount++;
+			}
+		}
+	}
+};
+
+static const IcoEdgeTable& getEdgeTable() {
+	static const IcoEdgeTable table;
+	return table;
+}
+
+static int faceInteriorCount(int n) {
+	return (n - 1) * (n - 2) / 2;
+}
+
+int IcosphereVertexCount(int resolution) {
+	int n = 1 << resolution;
+	return IcoVertexCount + getEdgeTable().edgeCount * (n - 1) + IcoFaceCount * faceInteriorCount(n);
+}
 
-	sphere.index.resize(totalIndexCount);
-	sphere.pos.resize(totalVertexCount);
-	sphere.uvs.resize(totalVertexCount);
-	
-	for (int i = 0; i < IcoVertexCount; i++) {  // Copy in initial mesh
-		sphere.pos[i] = IcoVerts[i];
-		sphere.uvs[i] = IcoUvs[i];
+int IcosphereIndexCount(int resolution) {
+	return IcoIndexCount << (resolution * 2);
+}
+
+// Subdividing a triangle 'resolution' times, and only normalizing at the end, puts the
+// vertices on a regular grid of n = 2^resolution steps across the flat base triangle.
+// So each vertex can be found from its grid coordinate instead of looking up its edge.
+//
+//     v2                 (0,n)
+//    /  \                 |   \.
+//   /    \    ---->      (0,1)--(1,1)
+//  /      \               |   \  |   \.
+// v0------v1            (0,0)--(1,0)--(2,0) ...
+//
+// (a, b) is at v0 + (v1 - v0) * a/n + (v2 - v0) * b/n. Vertices are stored as the 22
+// base vertices, then n-1 for each base edge, then the inside of each face row by row.
+// Faces only write their own inside vertices and triangles, so they can be split
+// across threads without any shared state.
+
+struct IcoGrid {
+	int n;
+	int edgeBase;
+	int faceBase;
+
+	IcoGrid(int resolution) {
+		n = 1 << resolution;
+		edgeBase = IcoVertexCount;
+		faceBase = edgeBase + getEdgeTable().edgeCount * (n - 1);
 	}
 
-	for (int i = 0; i < IcoIndexCount; i++) {
-		sphere.index[i] = IcoIndex[i];
+	int edgeVertex(int face, int edge, int t) const {
+		const IcoEdgeTable& table = getEdgeTable();
+
+		if (table.faceEdgeReversed[face][edge]) {
+			t = n - t;
+		}
+
+		return edgeBase + table.faceEdge[face][edge] * (n - 1) + t - 1;
 	}
- 
-	int currentVertexCount = IcoVertexCount;
-	int currentIndexCount = IcoIndexCount;
-
-	for (int r = 0; r < resolution; r++) {
-		// Now split the triangles.
-		// This can be done in place, but needs to keep track of the unique triangles
-		// 
-		//     i+2                 i+2
-		//    /   \               /  \
-		//   /     \    ---->   m2----m1
-		//  /       \          /  \  /  \
-		// i---------i+1      i----m0----i+1
- 
-		std::unordered_map<uint64_t, int> triangleFromEdge;
-		int indexCount = currentIndexCount;
 
-		for (int t = 0; t < indexCount; t += 3) {
-			int midpoints[3] = {};
+	int vertex(int face, int a, int b) const {
+		const int* corner = IcoIndex + face * 3;
 
-			for (int e = 0; e < 3; e++) {
-				int first = sphere.index[t + e];
-				int second = sphere.index[t + (t + e + 1) % 3];
+		if (a == 0 && b == 0) return corner[0];
+		if (a == n)           return corner[1];
+		if (b == n)           return corner[2];
 
-				if (first > second) {
-					std::swap(first, second);
-				}
+		if (b == 0)     return edgeVertex(face, 0, a); // v0 -> v1
+		if (a + b == n) return edgeVertex(face, 1, b); // v1 -> v2
+		if (a == 0)     return edgeVertex(face, 2, n - b); // v2 -> v0
 
-				uint64_t hash = (uint64_t)first | (uint64_t)second << (sizeof(uint32_t) * 8);
+		// rows of the inside have n-2, n-3, ... vertices
+		int row = b - 1;
+		int rowOffset = row * (n - 1) - row * (row + 1) / 2;
 
-				auto [triangle, wasNewEdge] = triangleFromEdge.insert({ hash, currentVertexCount });
+		return faceBase + face * faceInteriorCount(n) + rowOffset + a - 1;
+	}
+};
 
-				if (wasNewEdge) {
-					sphere.pos[currentVertexCount] = (sphere.pos[first] + sphere.pos[second]) / 2.0f;
-					sphere.uvs[currentVertexCount] = (sphere.uvs[first] + sphere.uvs[second]) / 2.0f;
+template<typename _write>
+static void writeVertex(_write& write, int vertex, int face, int a, int b, int n) {
+	const int* corner = IcoIndex + face * 3;
 
-					currentVertexCount += 1;
-				}
+	float u = a / (float)n;
+	float v = b / (float)n;
+
+	vec3 pos = IcoVerts[corner[0]] + (IcoVerts[corner[1]] - IcoVerts[corner[0]]) * u + (IcoVerts[corner[2]] - IcoVerts[corner[0]]) * v;
+	vec2 uv  = IcoUvs [corner[0]] + (IcoUvs [corner[1]] - IcoUvs [corner[0]]) * u + (IcoUvs [corner[2]] - IcoUvs [corner[0]]) * v;
 
-				midpoints[e] = triangle->second;
+	write(vertex, normalize(pos), uv);
+}
+
+// Write the inside vertices and the triangles of a range of faces
+template<typename _write>
+static void buildFaces(const IcoGrid& grid, int faceBegin, int faceEnd, int* index, _write& write) {
+	int n = grid.n;
+
+	for (int face = faceBegin; face < faceEnd; face++) {
+		int* out = index + face * n * n * 3;
+
+		for (int b = 1; b < n - 1; b++) {
+			for (int a = 1; a + b < n; a++) {
+				writeVertex(write, grid.vertex(face, a, b), face, a, b, n);
 			}
+		}
 
-			int mid0 = midpoints[0];
-			int mid1 = midpoints[1];
-			int mid2 = midpoints[2];
- 
-			sphere.index[currentIndexCount++] = sphere.index[t];
-			sphere.index[currentIndexCount++] = mid0;
-			sphere.index[currentIndexCount++] = mid2;
+		// both triangles keep the winding of the base face
+		for (int b = 0; b < n; b++) {
+			for (int a = 0; a + b < n; a++) {
+				*out++ = grid.vertex(face, a,     b);
+				*out++ = grid.vertex(face, a + 1, b);
+				*out++ = grid.vertex(face, a,     b + 1);
+
+				if (a + b < n - 1) {
+					*out++ = grid.vertex(face, a + 1, b);
+					*out++ = grid.vertex(face, a + 1, b + 1);
+					*out++ = grid.vertex(face, a,     b + 1);
+				}
+			}
+		}
+	}
+}
+
+// write(int vertex, vec3 pos, vec2 uv) is called once for every vertex, from any thread
+template<typename _write>
+static void buildIcosphere(int resolution, int* index, JobExecutor* jobs, _write&& write) {
+	IcoGrid grid(resolution);
+	const IcoEdgeTable& table = getEdgeTable();
+
+	for (int i = 0; i < IcoVertexCount; i++) {
+		write(i, normalize(IcoVerts[i]), IcoUvs[i]);
+	}
 
-			sphere.index[currentIndexCount++] = sphere.index[t + 1];
-			sphere.index[currentIndexCount++] = mid1;
-			sphere.index[currentIndexCount++] = mid0;
+	// each edge is written by the first face which uses it
+	std::vector<bool> written(table.edgeCount);
 
-			sphere.index[currentIndexCount++] = sphere.index[t + 2];
-			sphere.index[currentIndexCount++] = mid2;
-			sphere.index[currentIndexCount++] = mid1;
+	for (int face = 0; face < IcoFaceCount; face++) {
+		for (int e = 0; e < 3; e++) {
+			int edge = table.faceEdge[face][e];
 
-			sphere.index[t]     = mid0; // Overwrite the original triangle with the 4th new triangle
-			sphere.index[t + 1] = mid1;
-			sphere.index[t + 2] = mid2;
+			if (written[edge]) {
+				continue;
+			}
+
+			written[edge] = true;
+
+			for (int t = 1; t < grid.n; t++) {
+				int a = e == 0 ? t : e == 1 ? grid.n - t : 0;
+				int b = e == 0 ? 0 : e == 1 ? t : grid.n - t;
+
+				writeVertex(write, grid.vertex(face, a, b), face, a, b, grid.n);
+			}
 		}
 	}
 
-	// Normalize all the positions to create the sphere
+	// not worth the overhead of the jobs for small spheres
+	if (!jobs || resolution < 4) {
+		buildFaces(grid, 0, IcoFaceCount, index, write);
+		return;
+	}
 
-	for (vec3& pos : sphere.pos) {
-		pos = normalize(pos);
+	std::vector<int> faces(IcoFaceCount);
+	for (int i = 0; i < IcoFaceCount; i++) {
+		faces[i] = i;
 	}
 
+	JobWait wait;
+
+	JobTree& tree = jobs->CreateTree();
+
+	wait.After(tree.CreateEmpty()
+		.For(faces, [&](int face) {
+			buildFaces(grid, face, face + 1, index, write);
+		}));
+
+	jobs->Run(tree);
+	wait.Wait();
+}
+
+Icosphere MakeIcosphere(int resolution, JobExecutor* jobs) {
+	Icosphere sphere;
+	MakeIcosphere(resolution, sphere, jobs);
+
 	return sphere;
 }
+
+void MakeIcosphere(int resolution, Icosphere& sphere, JobExecutor* jobs) {
+	sphere.index.resize(IcosphereIndexCount(resolution));
+	sphere.pos.resize(IcosphereVertexCount(resolution));
+	sphere.uvs.resize(IcosphereVertexCount(resolution));
+
+	MakeIcosphere(resolution, sphere.pos, sphere.uvs, sphere.index, jobs);
+}
+
+void MakeIcosphere(int resolution, std::span<vec3> pos, std::span<vec2> uvs, std::span<int> index, JobExecutor* jobs) {
+	if (   pos.size() < (size_t)IcosphereVertexCount(resolution)
+		|| uvs.size() < (size_t)IcosphereVertexCount(resolution)
+		|| index.size() < (size_t)IcosphereIndexCount(resolution))
+	{
+		throw nullptr;
+	}
+
+	buildIcosphere(resolution, index.data(), jobs, [&](int vertex, vec3 p, vec2 uv) {
+		pos[vertex] = p;
+		uvs[vertex] = uv;
+	});
+}
+
+void MakeIcosphere(int resolution, std::span<IcosphereVertex> vertices, std::span<int> index, JobExecutor* jobs) {
+	if (   vertices.size() < (size_t)IcosphereVertexCount(resolution)
+		|| index.size() < (size_t)IcosphereIndexCount(resolution))
+	{
+		throw nullptr;
+	}
+
+	buildIcosphere(resolution, index.data(), jobs, [&](int vertex, vec3 p, vec2 uv) {
+		vertices[vertex] = { p, uv };
+	});
+}
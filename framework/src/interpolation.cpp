@@ -21,3 +21,60 @@ bool LinearInterpolator::more() const {
 vec2 LinearInterpolator::current() const {
 	return cur;
 }
+
+static const int CurveMaxSegments = 1024;
+static const int CurveBatchSize = 16;
+
+int bezierSegmentCount(vec2 p0, vec2 p1, vec2 p2, vec2 p3, float tolerance) {
+	// the second derivative is at most 6 times the largest second difference of the control points
+	float bend = max(length(p0 - 2.f * p1 + p2), length(p1 - 2.f * p2 + p3));
+	float segments = ceil(sqrt(6.f * bend / (8.f * max(tolerance, 1e-6f))));
+
+	return (int)clamp(segments, 1.f, (float)CurveMaxSegments);
+}
+
+void evaluateBezier(vec2 p0, vec2 p1, vec2 p2, vec2 p3, const float* t, int count, vec2* out) {
+	// power basis, ((a t + b) t + c) t + d
+	vec2 a = -p0 + 3.f * p1 - 3.f * p2 + p3;
+	vec2 b = 3.f * p0 - 6.f * p1 + 3.f * p2;
+	vec2 c = -3.f * p0 + 3.f * p1;
+	vec2 d = p0;
+
+	for (int begin = 0; begin < count; begin += CurveBatchSize) {
+		int size = min(count - begin, CurveBatchSize);
+
+		// x and y in separate arrays, so each loop is the same operation on a row of floats
+		float x[CurveBatchSize];
+		float y[CurveBatchSize];
+
+		for (int i = 0; i < CurveBatchSize; i++) {
+			float s = t[begin + min(i, size - 1)];
+			x[i] = ((a.x * s + b.x) * s + c.x) * s + d.x;
+			y[i] = ((a.y * s + b.y) * s + c.y) * s + d.y;
+		}
+
+		for (int i = 0; i < size; i++) {
+			out[begin + i] = vec2(x[i], y[i]);
+		}
+	}
+}
+
+void flattenBezier(vec2 p0, vec2 p1, vec2 p2, vec2 p3, float tolerance, std::vector<vec2>& out) {
+	int segments = bezierSegmentCount(p0, p1, p2, p3, tolerance);
+
+	float t[CurveMaxSegments];
+	for (int i = 0; i < segments; i++) {
+		t[i] = (float)(i + 1) / segments;
+	}
+
+	size_t first = out.size();
+	out.resize(first + segments);
+	evaluateBezier(p0, p1, p2, p3, t, segments, out.data() + first);
+
+	// exactly on the end, so curves which continue each other meet
+	out.back() = p3;
+}
+
+void flattenCatmullRom(vec2 p0, vec2 p1, vec2 p2, vec2 p3, float tolerance, std::vector<vec2>& out) {
+	flattenBezier(p1, p1 + (p2 - p0) / 6.f, p2 - (p3 - p1) / 6.f, p2, tolerance, out);
+}
@@ -141,10 +141,16 @@ void JobExecutor::WaitForAll() {
 
 JobTree& JobExecutor::CreateTree() {
 	JobTree* tree = new JobTree();
+
+	std::scoped_lock lock(ownedTreesMutex);
 	ownedTrees.push_back(tree);
 	return *tree;
 }
 
+int JobExecutor::ThreadCount() const {
+	return (int)threads.size();
+}
+
 void JobExecutor::ThreadWork(JobThreadContext* ctx) {
 	while (true) {
 		JobNode* node = wavefront.pop_back();
@@ -180,8 +186,13 @@ void JobExecutor::ThreadWork(JobThreadContext* ctx) {
 		node->tree->nodeCount -= 1;
 
 		if (node->tree->nodeCount == 0) {
-			ownedTrees.erase(std::find(ownedTrees.begin(), ownedTrees.end(), node->tree));
-			delete node->tree;
+			std::scoped_lock lock(ownedTreesMutex);
+
+			auto itr = std::find(ownedTrees.begin(), ownedTrees.end(), node->tree);
+			if (itr != ownedTrees.end()) { // only delete trees made with CreateTree
+				ownedTrees.erase(itr);
+				delete node->tree;
+			}
 		}
 	}
 }
@@ -217,4 +228,24 @@ void JobExecutor::DestroyThreads() {
 	}
 
 	threads.clear();
+}
+
+JobWait::JobWait()
+	: state (std::make_shared<State>())
+{}
+
+void JobWait::After(Job job) {
+	job.Then([state = state](Job _) {
+		{
+			std::scoped_lock lock(state->mutex);
+			state->done = true;
+		}
+
+		state->condition.notify_all();
+	});
+}
+
+void JobWait::Wait() {
+	std::unique_lock lock(state->mutex);
+	state->condition.wait(lock, [this]() { return state->done; });
 }
\ No newline at end of file
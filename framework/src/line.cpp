@@ -1,13 +1,37 @@
 #include "lith/line.h"
+#include "lith/profile.h"
+
+// matches MiterLimit in the shader, sharper joins are drawn round
+constexpr float LineMiterLimit = 4.f;
 
 void LineMesh::create() {
+	QuadVertexData quad[4] = {
+		{ vec2(0, -1) },
+		{ vec2(0,  1) },
+		{ vec2(1,  1) },
+		{ vec2(1, -1) }
+	};
+
 	mesh = VertexArrayBuilder()
-		.topology(TopologyLines)
-		.buffer(0).host().data(sizeof(LineVertex))
+		.topology(TopologyTriangles)
+		.index().data({0, 1, 2, 0, 3, 2})
+		.buffer(0).data(sizeof(QuadVertexData), sizeof(quad), quad)
+		.buffer(1).data(sizeof(InstanceVertexData))
+			.host()
 		.map(0)
-			.attribute(0).type(AttributeTypeFloat, 3)
-			.attribute(1).type(AttributeTypeFloat, 4)
+			.attribute(0).type(AttributeTypeFloat, 2)
+		.map(1)
+			.instanced()
+			.attribute(1).type(AttributeTypeFloat, 3)
+			.attribute(2).type(AttributeTypeFloat, 3)
+			.attribute(3).type(AttributeTypeFloat, 2)
+			.attribute(4).type(AttributeTypeFloat, 2)
+			.attribute(7).type(AttributeTypeUByteNorm, 4)
+			.attribute(5).type(AttributeTypeHalf, 1)
+			.attribute(6).type(AttributeTypeUByte, 1)
 		.build();
+
+	instances = &mesh.buffer(1);
 }
 
 void LineMesh::free() {
@@ -19,42 +43,212 @@ void LineMesh::draw() {
 }
 
 void LineMesh::clear() {
-	mesh.clear();
+	mesh.clearInstances();
+}
+
+void LineMesh::addLine(vec3 a, vec3 b, vec4 stroke, float weight, StrokeCap cap) {
+	instances->data.add(makeLineSegment(a, b, vec2(a), vec2(b), stroke, weight, cap, StrokeJoinMiter));
+}
+
+void LineMesh::addLines(const InstanceVertexData* segments, int count) {
+	instances->data.addMany(segments, count);
+}
+
+CullStats LineMesh::cull(const ViewBounds& view, float pixelSize) {
+	LITH_PROFILE_SCOPE("cull lines");
+
+	int count = instances->data.count();
+	boxes.resize(count);
+
+	for (int i = 0; i < count; i++) {
+		const InstanceVertexData& segment = instances->data.at<InstanceVertexData>(i);
+
+		float outset = max(unpackHalf(segment.weight) * 0.5f, pixelSize * 0.5f) + pixelSize;
+		vec2 pad = vec2(outset * LineMiterLimit);
+
+		boxes.set(i, min(vec2(segment.a), vec2(segment.b)) - pad, max(vec2(segment.a), vec2(segment.b)) + pad);
+	}
+
+	int visibleCount = boxes.cull(view);
+	keepVisible(instances->data, boxes.visible.data(), visibleCount);
+
+	return { count, visibleCount };
+}
+
+void LineMesh::upload() {
+	mesh.upload();
+}
+
+void LineMesh::drawUploaded() const {
+	mesh.draw();
 }
 
-void LineMesh::addLine(vec3 a, vec3 b, vec4 stroke, float strokeThickness) {
-	mesh.bufferData(0).addMany({
-		LineVertex{ a, stroke }, 
-		LineVertex{ b, stroke }
-	});
+void LineMesh::setLines(int first, const InstanceVertexData* segments, int count) {
+	for (int i = 0; i < count; i++) {
+		instances->data.at<InstanceVertexData>(first + i) = segments[i];
+	}
+
+	mesh.uploadRange(1, first, count);
+}
+
+LineMesh::InstanceVertexData makeLineSegment(vec3 a, vec3 b, vec2 before, vec2 after, vec4 stroke, float weight, StrokeCap cap, StrokeJoin join) {
+	LineMesh::InstanceVertexData segment;
+	segment.a = a;
+	segment.b = b;
+	segment.before = before;
+	segment.after = after;
+	segment.stroke = packColor(stroke);
+	segment.weight = packHalf(weight);
+	segment.style = (uint8_t)(cap | join << 2);
+
+	return segment;
 }
 
 void LineShaderProgram::create() {
 	const char* vertexShaderSource = R"(
 		#version 330 core
 
-		layout (location = 0) in vec3 pos;
-		layout (location = 1) in vec4 stroke;
+		layout (location = 0) in vec2 pos;
+		layout (location = 1) in vec3 instanceA;
+		layout (location = 2) in vec3 instanceB;
+		layout (location = 3) in vec2 instanceBefore;
+		layout (location = 4) in vec2 instanceAfter;
+		layout (location = 5) in float instanceWeight;
+		layout (location = 6) in float instanceStyle;
+		layout (location = 7) in vec4 instanceStroke;
 
 		uniform mat4 view;
 		uniform mat4 proj;
+		uniform float pixelSize;
+
+		const int CapRound = 0;
+		const int CapSquare = 1;
+		const int JoinRound = 1;
+		const float MiterLimit = 4.0;
+
+		// how each end is cut in the fragment shader
+		const float EndOpen = 0.0; // by the geometry, along the miter
+		const float EndBox = 1.0;
+		const float EndRound = 2.0;
 
+		out vec2 fragPos;
+		flat out vec2 fragA;
+		flat out vec2 fragDir;
+		flat out float fragLength;
+		flat out float fragHalfWeight;
+		flat out vec4 fragEnds; // mode and extension of a, then of b
 		out vec4 fragStroke;
 
+		int cap;
+		int join;
+		float halfWeight;
+		float outset;
+
+		// Returns the mode and extension of an end, and the offset of this vertex from it
+		vec2 shapeEnd(vec2 point, vec2 neighbour, vec2 dir, bool start, out vec2 offset) {
+			vec2 normal = vec2(-dir.y, dir.x);
+			vec2 outward = start ? -dir : dir;
+
+			if (neighbour == point) {
+				float extension = cap == CapSquare ? 0.0 : halfWeight;
+				offset = normal * pos.y * outset + outward * (extension + pixelSize);
+				return vec2(cap == CapRound ? EndRound : EndBox, extension);
+			}
+
+			// the neighbour's direction, going the same way as this segment
+			vec2 other = normalize(start ? point - neighbour : neighbour - point);
+			vec2 miter = normal + vec2(-other.y, other.x);
+			float miterScale = length(miter) > 1e-4 ? 1.0 / dot(normalize(miter), normal) : MiterLimit + 1.0;
+
+			if (join == JoinRound || miterScale > MiterLimit) {
+				offset = normal * pos.y * outset + outward * outset;
+				return vec2(EndRound, 0.0);
+			}
+
+			// both segments end on the miter line, so they meet without overlapping
+			offset = normalize(miter) * pos.y * outset * miterScale;
+			return vec2(EndOpen, 0.0);
+		}
+
 		void main() {
-			gl_Position = proj * view * vec4(pos, 1.0);
-			fragStroke = stroke;
+			int style = int(instanceStyle + 0.5);
+			cap = style & 3;
+			join = style >> 2;
+
+			vec2 a = instanceA.xy;
+			vec2 b = instanceB.xy;
+
+			float len = length(b - a);
+			vec2 dir = len > 0.0 ? (b - a) / len : vec2(1.0, 0.0);
+
+			halfWeight = instanceWeight * 0.5;
+			outset = max(halfWeight, pixelSize * 0.5) + pixelSize;
+
+			// flat values come from one vertex, so every vertex works out both ends
+			vec2 offsetA;
+			vec2 offsetB;
+			vec2 endA = shapeEnd(a, instanceBefore, dir, true, offsetA);
+			vec2 endB = shapeEnd(b, instanceAfter, dir, false, offsetB);
+
+			bool atA = pos.x == 0.0;
+
+			fragPos = atA ? a + offsetA : b + offsetB;
+			fragA = a;
+			fragDir = dir;
+			fragLength = len;
+			fragHalfWeight = halfWeight;
+			fragEnds = vec4(endA, endB);
+			fragStroke = instanceStroke;
+
+			float z = atA ? instanceA.z : instanceB.z;
+			gl_Position = proj * view * vec4(fragPos, z, 1.0);
 		}
 	)";
 
+	// The distance to the segment, cut at each end by its mode, gives the anti-aliased edge
 	const char* fragmentShaderSource = R"(
 		#version 330 core
 
+		in vec2 fragPos;
+		flat in vec2 fragA;
+		flat in vec2 fragDir;
+		flat in float fragLength;
+		flat in float fragHalfWeight;
+		flat in vec4 fragEnds;
 		in vec4 fragStroke;
+
 		out vec4 outColor;
 
+		const float EndBox = 1.0;
+		const float EndRound = 2.0;
+
 		void main() {
-			outColor = fragStroke;
+			vec2 p = fragPos - fragA;
+			float along = dot(p, fragDir);
+			float across = abs(dot(p, vec2(-fragDir.y, fragDir.x)));
+
+			float pastA = -along;
+			float pastB = along - fragLength;
+
+			float pixel = length(fwidth(fragPos)) * 0.7071;
+			float halfWeight = max(fragHalfWeight, pixel * 0.5);
+
+			float distance = across;
+			if (fragEnds.x == EndRound && pastA > 0.0) distance = length(vec2(pastA, across));
+			if (fragEnds.z == EndRound && pastB > 0.0) distance = length(vec2(pastB, across));
+
+			distance -= halfWeight;
+			if (fragEnds.x == EndBox) distance = max(distance, pastA - fragEnds.y);
+			if (fragEnds.z == EndBox) distance = max(distance, pastB - fragEnds.w);
+
+			// lines thinner than a pixel fade out instead of breaking up
+			float coverage = clamp(0.5 - distance / pixel, 0.0, 1.0) * min(fragHalfWeight * 2.0 / pixel, 1.0);
+
+			if (coverage <= 0.0) {
+				discard;
+			}
+
+			outColor = vec4(fragStroke.rgb, fragStroke.a * coverage);
 		}
 	)";
 
@@ -69,10 +263,11 @@ void LineShaderProgram::free() {
 	program.free();
 }
 
-void LineShaderProgram::use(const mat4& view, const mat4& proj) {
+void LineShaderProgram::use(const mat4& view, const mat4& proj, float pixelSize) {
 	program.use();
 	program.setf16("view", view);
 	program.setf16("proj", proj);
+	program.setf("pixelSize", pixelSize);
 }
 
 void LineRenderer::create() {
@@ -85,15 +280,34 @@ void LineRenderer::free() {
 	mesh.free();
 }
 
-void LineRenderer::draw(const mat4& view, const mat4& proj) {
-	shader.use(view, proj);
+void LineRenderer::draw(const mat4& view, const mat4& proj, float pixelSize) {
+	lastStats = mesh.cull(getViewBounds(proj * view), pixelSize);
+
+	if (lastStats.visibleCount == 0) {
+		return;
+	}
+
+	shader.use(view, proj, pixelSize);
 	mesh.draw();
 }
 
+void LineRenderer::drawMesh(const LineMesh& mesh, const mat4& view, const mat4& proj, float pixelSize) {
+	shader.use(view, proj, pixelSize);
+	mesh.drawUploaded();
+}
+
+const CullStats& LineRenderer::stats() const {
+	return lastStats;
+}
+
 void LineRenderer::clear() {
 	mesh.clear();
 }
 
-void LineRenderer::addLine(vec3 a, vec3 b, vec4 stroke, float strokeThickness) {
-	mesh.addLine(a, b, stroke, strokeThickness);
-}
\ No newline at end of file
+void LineRenderer::addLine(vec3 a, vec3 b, vec4 stroke, float weight, StrokeCap cap) {
+	mesh.addLine(a, b, stroke, weight, cap);
+}
+
+void LineRenderer::addLines(const LineMesh::InstanceVertexData* segments, int count) {
+	mesh.addLines(segments, count);
+}
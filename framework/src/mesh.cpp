@@ -1,6 +1,7 @@
 #include "lith/mesh.h"
 #include "lith/log.h"
 #include "gl/glad.h"
+#include "glm/gtc/packing.hpp"
 #include <algorithm>
 
 GLenum getVertexArrayTopology(VertexArrayTopology topology) {
@@ -19,13 +20,47 @@ GLenum getVertexArrayTopology(VertexArrayTopology topology) {
 
 GLenum getVertexArrayAttributeType(VertexArrayAttributeType type) {
 	switch (type) {
-		case AttributeTypeFloat: return GL_FLOAT;
-		case AttributeTypeInt:   return GL_INT;
+		case AttributeTypeFloat:      return GL_FLOAT;
+		case AttributeTypeInt:        return GL_INT;
+		case AttributeTypeHalf:       return GL_HALF_FLOAT;
+		case AttributeTypeUShortNorm: return GL_UNSIGNED_SHORT;
+		case AttributeTypeUByte:      return GL_UNSIGNED_BYTE;
+		case AttributeTypeUByteNorm:  return GL_UNSIGNED_BYTE;
 	}
 
 	throw nullptr;
 }
 
+int getVertexArrayAttributeTypeSize(VertexArrayAttributeType type) {
+	switch (type) {
+		case AttributeTypeFloat:      return 4;
+		case AttributeTypeInt:        return 4;
+		case AttributeTypeHalf:       return 2;
+		case AttributeTypeUShortNorm: return 2;
+		case AttributeTypeUByte:      return 1;
+		case AttributeTypeUByteNorm:  return 1;
+	}
+
+	throw nullptr;
+}
+
+bool isVertexArrayAttributeNormalized(VertexArrayAttributeType type) {
+	return type == AttributeTypeUShortNorm
+		|| type == AttributeTypeUByteNorm;
+}
+
+uint32_t packColor(vec4 color) {
+	return packUnorm4x8(color);
+}
+
+uint16_t packHalf(float value) {
+	return packHalf1x16(value);
+}
+
+float unpackHalf(uint16_t value) {
+	return unpackHalf1x16(value);
+}
+
 VertexBuffer::VertexBuffer()
 	: id                          (0)
 	, type                        (0)
@@ -187,10 +222,11 @@ VertexArray& VertexArray::upload() {
 			void* offsetPtr = (void*)offset;
 
 			GLenum attributeType = getVertexArrayAttributeType(a.type);
+			GLboolean normalized = isVertexArrayAttributeNormalized(a.type) ? GL_TRUE : GL_FALSE;
 
 			glBindBuffer(a.buffer->type, a.buffer->handle);
 			glEnableVertexAttribArray(a.id);
-			glVertexAttribPointer(a.id, a.count, attributeType, GL_FALSE, a.buffer->data.stride(), offsetPtr);
+			glVertexAttribPointer(a.id, a.count, attributeType, normalized, a.buffer->data.stride(), offsetPtr);
 			glVertexAttribDivisor(a.id, a.instanceStride);
 		}
 
@@ -215,6 +251,22 @@ VertexArray& VertexArray::upload() {
 	return *this;
 }
 
+VertexArray& VertexArray::uploadRange(int bufferID, int first, int count) {
+	VertexBuffer& b = buffer(bufferID);
+
+	if (b.handle == 0 || count <= 0) {
+		return *this;
+	}
+
+	int stride = b.data.stride();
+	const char* bytes = (const char*)b.data.data();
+
+	glBindBuffer(b.type, b.handle);
+	glBufferSubData(b.type, (GLintptr)first * stride, (GLsizeiptr)count * stride, bytes + first * stride);
+
+	return *this;
+}
+
 void VertexArray::free() {
 	for (VertexBuffer& b : data.buffers) {
 		glDeleteBuffers(1, &b.handle);
@@ -241,7 +293,7 @@ void VertexArray::clearInstances() {
 	}
 }
 
-void VertexArray::draw() {
+void VertexArray::draw() const {
 	glBindVertexArray(handle);
 
 	GLenum topology = getVertexArrayTopology(data.topology);
@@ -257,6 +309,15 @@ void VertexArray::draw() {
 	}
 }
 
+void VertexArray::drawInstanced(int instanceCount) const {
+	glBindVertexArray(handle);
+
+	GLenum topology = getVertexArrayTopology(data.topology);
+
+	if (hasIndexBuffer) { glDrawElementsInstanced(topology, indexCount, GL_UNSIGNED_INT, nullptr, instanceCount); }
+	else                { glDrawArraysInstanced(topology, 0, vertexCount, instanceCount); }
+}
+
 VertexArrayBuilder& VertexArrayBuilder::topology(VertexArrayTopology topology) {
 	building.topology = topology;
         
@@ -294,7 +355,7 @@ VertexArrayBuilder& VertexArrayBuilder::map(int bufferID) {
 VertexArrayBuilder& VertexArrayBuilder::attribute(int attributeID) {
 	// calculate offset before currentAttribute is invalidated by emplace_back
 	int offset = currentAttribute
-		? currentAttribute->offset + currentAttribute->count * 4 // todo: get type size
+		? currentAttribute->offset + currentAttribute->count * getVertexArrayAttributeTypeSize(currentAttribute->type)
 		: 0;
 
 	VertexArrayAttribute& attribute = building.attributes.emplace_back();
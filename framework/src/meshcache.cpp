@@ -0,0 +1,221 @@
+#include "lith/meshcache.h"
+#include "lith/meshopt.h"
+#include "lith/icosphere.h"
+#include "lith/uvsphere.h"
+#include "lith/capsule.h"
+#include "lith/plane.h"
+#include "glm/gtc/packing.hpp"
+#include <functional>
+
+static MeshCacheContext* ctx = nullptr;
+
+void registerMeshCacheContext(MeshCacheContext* context) {
+	ctx = context;
+}
+
+bool MeshKey::operator==(const MeshKey& other) const {
+	return generator == other.generator
+		&& ints[0] == other.ints[0]
+		&& ints[1] == other.ints[1]
+		&& floats[0] == other.floats[0]
+		&& floats[1] == other.floats[1]
+		&& options.optimizeVertexCache == other.options.optimizeVertexCache
+		&& options.optimizeVertexFetch == other.options.optimizeVertexFetch
+		&& options.layout == other.options.layout;
+}
+
+size_t MeshKeyHash::operator()(const MeshKey& key) const {
+	size_t hash = std::hash<int>()(key.generator);
+
+	auto combine = [&](size_t value) {
+		hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+	};
+
+	combine(std::hash<int>()(key.ints[0]));
+	combine(std::hash<int>()(key.ints[1]));
+	combine(std::hash<float>()(key.floats[0]));
+	combine(std::hash<float>()(key.floats[1]));
+	combine(key.options.optimizeVertexCache | key.options.optimizeVertexFetch << 1 | key.options.layout << 2);
+
+	return hash;
+}
+
+static VertexArray uploadMesh(const std::vector<int>& index, const std::vector<vec3>& pos, const std::vector<vec2>& uvs, MeshLayout layout) {
+	VertexArrayBuilder builder;
+	builder
+		.topology(TopologyTriangles)
+		.index().data(index);
+
+	if (layout == MeshLayoutQuantized) {
+		std::vector<MeshVertexQuantized> vertices(pos.size());
+
+		for (size_t i = 0; i < pos.size(); i++) {
+			MeshVertexQuantized& vertex = vertices[i];
+			vertex.pos[0] = packHalf1x16(pos[i].x);
+			vertex.pos[1] = packHalf1x16(pos[i].y);
+			vertex.pos[2] = packHalf1x16(pos[i].z);
+			vertex.pos[3] = 0;
+			vertex.uv[0] = packUnorm1x16(uvs[i].x);
+			vertex.uv[1] = packUnorm1x16(uvs[i].y);
+		}
+
+		builder
+			.buffer(0).data(vertices)
+			.map(0)
+				.attribute(0).type(AttributeTypeHalf, 4)
+				.attribute(1).type(AttributeTypeUShortNorm, 2);
+	}
+
+	else {
+		std::vector<MeshVertex> vertices(pos.size());
+
+		for (size_t i = 0; i < pos.size(); i++) {
+			vertices[i] = { pos[i], uvs[i] };
+		}
+
+		builder
+			.buffer(0).data(vertices)
+			.map(0)
+				.attribute(0).type(AttributeTypeFloat, 3)
+				.attribute(1).type(AttributeTypeFloat, 2);
+	}
+
+	VertexArray mesh = builder.build();
+
+	// cached meshes are never changed, so only keep them on the GPU
+	mesh.index().freeHostAfterUpload = true;
+	mesh.buffer(0).freeHostAfterUpload = true;
+	mesh.upload();
+
+	return mesh;
+}
+
+// Takes the generated mesh by value to optimize it in place
+static CachedMesh* buildMesh(std::vector<int> index, std::vector<vec3> pos, std::vector<vec2> uvs, const MeshOptions& options) {
+	int vertexCount = (int)pos.size();
+
+	MeshStats stats;
+	stats.vertexCount = vertexCount;
+	stats.indexCount = (int)index.size();
+	stats.vertexBytes = vertexCount * (options.layout == MeshLayoutQuantized ? sizeof(MeshVertexQuantized) : sizeof(MeshVertex));
+	stats.acmrBefore = lithMeasureACMR(index, vertexCount);
+
+	if (options.optimizeVertexCache) {
+		lithOptimizeVertexCache(index, vertexCount);
+	}
+
+	if (options.optimizeVertexFetch) {
+		std::vector<int> remap = lithOptimizeVertexFetch(index, vertexCount);
+		lithRemapVertices(pos, remap);
+		lithRemapVertices(uvs, remap);
+	}
+
+	stats.acmrAfter = lithMeasureACMR(index, vertexCount);
+
+	float radius = 0.f;
+	for (const vec3& p : pos) {
+		radius = max(radius, length(p));
+	}
+
+	CachedMesh* mesh = new CachedMesh();
+	mesh->mesh = uploadMesh(index, pos, uvs, options.layout);
+	mesh->stats = stats;
+	mesh->radius = radius;
+
+	return mesh;
+}
+
+template<typename _generate>
+static const CachedMesh* getMesh(const MeshKey& key, _generate&& generate) {
+	std::scoped_lock lock(ctx->mutex);
+
+	auto itr = ctx->meshes.find(key);
+	if (itr != ctx->meshes.end()) {
+		return itr->second;
+	}
+
+	auto generated = generate();
+	CachedMesh* mesh = buildMesh(std::move(generated.index), std::move(generated.pos), std::move(generated.uvs), key.options);
+	ctx->meshes.emplace(key, mesh);
+
+	return mesh;
+}
+
+const CachedMesh* lithMeshIcosphere(int resolution, const MeshOptions& options) {
+	MeshKey key = { MeshGeneratorIcosphere, { resolution, 0 }, { 0.f, 0.f }, options };
+	return getMesh(key, [&]() { return MakeIcosphere(resolution); });
+}
+
+const CachedMesh* lithMeshUVSphere(int latCount, int lonCount, const MeshOptions& options) {
+	MeshKey key = { MeshGeneratorUVSphere, { latCount, lonCount }, { 0.f, 0.f }, options };
+	return getMesh(key, [&]() { return MakeUVSphere(latCount, lonCount); });
+}
+
+const CachedMesh* lithMeshCapsule(int resolution, float height, float radius, const MeshOptions& options) {
+	MeshKey key = { MeshGeneratorCapsule, { resolution, 0 }, { height, radius }, options };
+	return getMesh(key, [&]() { return MakeCapsule(resolution, height, radius); });
+}
+
+const CachedMesh* lithMeshPlane(int xCount, int yCount, const MeshOptions& options) {
+	MeshKey key = { MeshGeneratorPlane, { xCount, yCount }, { 0.f, 0.f }, options };
+	return getMesh(key, [&]() { return MakePlane(xCount, yCount); });
+}
+
+struct Box {
+	std::vector<int> index;
+	std::vector<vec3> pos;
+	std::vector<vec2> uvs;
+};
+
+static Box makeBox() {
+	Box box;
+
+	// each face is a quad on the +normal side, spanned by 'u' and 'v' so that
+	// u x v = normal, which keeps the winding counter-clockwise from outside
+	const vec3 faces[6][3] = {
+		{ vec3( 1, 0, 0), vec3( 0, 0, -1), vec3(0, 1,  0) },
+		{ vec3(-1, 0, 0), vec3( 0, 0,  1), vec3(0, 1,  0) },
+		{ vec3( 0, 1, 0), vec3( 1, 0,  0), vec3(0, 0, -1) },
+		{ vec3( 0,-1, 0), vec3( 1, 0,  0), vec3(0, 0,  1) },
+		{ vec3( 0, 0, 1), vec3( 1, 0,  0), vec3(0, 1,  0) },
+		{ vec3( 0, 0,-1), vec3(-1, 0,  0), vec3(0, 1,  0) }
+	};
+
+	const vec2 corners[4] = { vec2(0, 0), vec2(1, 0), vec2(1, 1), vec2(0, 1) };
+
+	for (const auto& [normal, u, v] : faces) {
+		int first = (int)box.pos.size();
+
+		for (vec2 corner : corners) {
+			box.pos.push_back((normal + u * (corner.x * 2.f - 1.f) + v * (corner.y * 2.f - 1.f)) * 0.5f);
+			box.uvs.push_back(corner);
+		}
+
+		for (int i : { 0, 1, 2, 0, 2, 3 }) {
+			box.index.push_back(first + i);
+		}
+	}
+
+	return box;
+}
+
+const CachedMesh* lithMeshBox(const MeshOptions& options) {
+	MeshKey key = { MeshGeneratorBox, { 0, 0 }, { 0.f, 0.f }, options };
+	return getMesh(key, [&]() { return makeBox(); });
+}
+
+void lithMeshCacheClear() {
+	std::scoped_lock lock(ctx->mutex);
+
+	for (auto& [key, mesh] : ctx->meshes) {
+		mesh->mesh.free();
+		delete mesh;
+	}
+
+	ctx->meshes.clear();
+	ctx->generation += 1;
+}
+
+int lithMeshCacheGeneration() {
+	return ctx ? ctx->generation : 0;
+}
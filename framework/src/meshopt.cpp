@@ -0,0 +1,208 @@
+#include "lith/meshopt.h"
+#include <algorithm>
+#include <cmath>
+
+// Scores from the paper, the cache it models is a bit bigger than most real FIFOs
+// so vertices near the end still have some value
+
+constexpr int ForsythCacheSize = 32;
+constexpr float ForsythCacheDecayPower = 1.5f;
+constexpr float ForsythLastTriangleScore = 0.75f;
+constexpr float ForsythValenceBoostScale = 2.0f;
+constexpr float ForsythValenceBoostPower = 0.5f;
+
+struct ForsythVertex {
+	int cachePosition = -1;
+	int activeTriangles = 0;
+	int firstTriangle = 0; // into the adjacency list
+	float score = 0.f;
+};
+
+static float forsythScore(const ForsythVertex& vertex) {
+	if (vertex.activeTriangles == 0) {
+		return -1.f;
+	}
+
+	float score = 0.f;
+
+	if (vertex.cachePosition >= 0) {
+		// the last triangle's vertices get a fixed score, so the next triangle doesn't
+		// just repeat them in a strip
+		if (vertex.cachePosition < 3) {
+			score = ForsythLastTriangleScore;
+		}
+
+		else {
+			const float scaler = 1.f / (ForsythCacheSize - 3);
+			score = powf(1.f - (vertex.cachePosition - 3) * scaler, ForsythCacheDecayPower);
+		}
+	}
+
+	// boost vertices with few triangles left, to finish them off instead of leaving holes
+	score += ForsythValenceBoostScale * powf((float)vertex.activeTriangles, -ForsythValenceBoostPower);
+
+	return score;
+}
+
+void lithOptimizeVertexCache(std::span<int> index, int vertexCount) {
+	int triangleCount = (int)index.size() / 3;
+
+	if (triangleCount == 0) {
+		return;
+	}
+
+	std::vector<ForsythVertex> vertices(vertexCount);
+
+	for (int i : index) {
+		vertices[i].activeTriangles += 1;
+	}
+
+	// triangles of each vertex, packed into one list
+	std::vector<int> adjacency(triangleCount * 3);
+	{
+		int offset = 0;
+		for (ForsythVertex& vertex : vertices) {
+			vertex.firstTriangle = offset;
+			offset += vertex.activeTriangles;
+			vertex.activeTriangles = 0;
+		}
+
+		for (int t = 0; t < triangleCount; t++) {
+			for (int k = 0; k < 3; k++) {
+				ForsythVertex& vertex = vertices[index[t * 3 + k]];
+				adjacency[vertex.firstTriangle + vertex.activeTriangles++] = t;
+			}
+		}
+	}
+
+	for (ForsythVertex& vertex : vertices) {
+		vertex.score = forsythScore(vertex);
+	}
+
+	std::vector<bool> triangleAdded(triangleCount);
+
+	std::vector<int> output;
+	output.reserve(index.size());
+
+	// +3 so the new triangle can be pushed before the old ones fall off
+	int cache[ForsythCacheSize + 3];
+	int cacheCount = 0;
+
+	int bestTriangle = -1;
+	float bestScore = -1.f;
+	int scanNext = 0; // for when nothing in the cache has triangles left
+
+	for (int added = 0; added < triangleCount; added++) {
+		if (bestTriangle < 0) {
+			while (triangleAdded[scanNext]) {
+				scanNext += 1;
+			}
+
+			bestTriangle = scanNext;
+		}
+
+		int t = bestTriangle;
+		triangleAdded[t] = true;
+
+		int corners[3] = { index[t * 3], index[t * 3 + 1], index[t * 3 + 2] };
+		output.insert(output.end(), corners, corners + 3);
+
+		// remove the triangle from its vertices' active lists
+		for (int v : corners) {
+			ForsythVertex& vertex = vertices[v];
+			int* list = adjacency.data() + vertex.firstTriangle;
+			int* position = std::find(list, list + vertex.activeTriangles, t);
+
+			std::swap(*position, list[vertex.activeTriangles - 1]);
+			vertex.activeTriangles -= 1;
+		}
+
+		// move the corners to the front of the cache, keeping the order of the rest
+		int newCache[ForsythCacheSize + 3];
+		int newCount = 0;
+
+		for (int v : corners) {
+			newCache[newCount++] = v;
+		}
+
+		for (int i = 0; i < cacheCount; i++) {
+			int v = cache[i];
+			if (v != corners[0] && v != corners[1] && v != corners[2]) {
+				newCache[newCount++] = v;
+			}
+		}
+
+		// update the scores of everything which moved, and of the vertices pushed out
+		for (int i = 0; i < newCount; i++) {
+			ForsythVertex& vertex = vertices[newCache[i]];
+			vertex.cachePosition = i < ForsythCacheSize ? i : -1;
+			vertex.score = forsythScore(vertex);
+		}
+
+		cacheCount = std::min(newCount, ForsythCacheSize);
+		std::copy(newCache, newCache + cacheCount, cache);
+
+		// the best next triangle is almost always one touching the cache
+		bestTriangle = -1;
+		bestScore = -1.f;
+
+		for (int i = 0; i < newCount; i++) {
+			const ForsythVertex& vertex = vertices[newCache[i]];
+			const int* list = adjacency.data() + vertex.firstTriangle;
+
+			for (int k = 0; k < vertex.activeTriangles; k++) {
+				int other = list[k];
+				float score = vertices[index[other * 3]].score + vertices[index[other * 3 + 1]].score + vertices[index[other * 3 + 2]].score;
+
+				if (score > bestScore) {
+					bestScore = score;
+					bestTriangle = other;
+				}
+			}
+		}
+	}
+
+	std::copy(output.begin(), output.end(), index.begin());
+}
+
+std::vector<int> lithOptimizeVertexFetch(std::span<int> index, int vertexCount) {
+	std::vector<int> remap(vertexCount, -1);
+	int next = 0;
+
+	for (int& i : index) {
+		if (remap[i] < 0) {
+			remap[i] = next++;
+		}
+
+		i = remap[i];
+	}
+
+	for (int& r : remap) {
+		if (r < 0) {
+			r = next++;
+		}
+	}
+
+	return remap;
+}
+
+float lithMeasureACMR(std::span<const int> index, int vertexCount, int cacheSize) {
+	int triangleCount = (int)index.size() / 3;
+
+	if (triangleCount == 0) {
+		return 0.f;
+	}
+
+	// a vertex is in the FIFO if it was pushed less than cacheSize misses ago
+	std::vector<int> pushedAt(vertexCount, -cacheSize - 1);
+	int misses = 0;
+
+	for (int i : index) {
+		if (misses - pushedAt[i] > cacheSize) {
+			pushedAt[i] = misses;
+			misses += 1;
+		}
+	}
+
+	return misses / (float)triangleCount;
+}
@@ -0,0 +1,362 @@
+#include "lith/meshrender.h"
+#include "lith/job.h"
+#include "lith/profile.h"
+#include "gl/glad.h"
+
+#include <algorithm>
+
+// instances in a single culling job
+constexpr int MeshCullChunk = 4096;
+
+// below this, culling on the calling thread is faster than waking the jobs
+constexpr int MeshCullParallelCount = 4 * MeshCullChunk;
+
+MeshInstance makeMeshInstance(vec3 position, vec3 scale, quat rotation, vec4 color) {
+	MeshInstance instance;
+	instance.position = vec4(position, 0.f);
+	instance.scale = vec4(scale, 0.f);
+	instance.rotation = vec4(rotation.x, rotation.y, rotation.z, rotation.w);
+	instance.color = color;
+
+	return instance;
+}
+
+void MeshProgram::create() {
+	const char* vertexShaderSource = R"(
+		#version 330 core
+
+		layout (location = 0) in vec3 pos;
+		layout (location = 1) in vec2 uv;
+
+		uniform mat4 view;
+		uniform mat4 proj;
+		uniform samplerBuffer instances;
+		uniform int instanceOffset;
+
+		out vec3 fragWorld;
+		out vec2 fragUv;
+		out vec4 fragColor;
+
+		vec3 rotate(vec4 q, vec3 v) {
+			return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+		}
+
+		void main() {
+			int base = (instanceOffset + gl_InstanceID) * 4;
+
+			vec3 position = texelFetch(instances, base + 0).xyz;
+			vec3 scale    = texelFetch(instances, base + 1).xyz;
+			vec4 rotation = texelFetch(instances, base + 2);
+			vec4 color    = texelFetch(instances, base + 3);
+
+			vec3 world = position + rotate(rotation, pos * scale);
+
+			gl_Position = proj * view * vec4(world, 1.0);
+			fragWorld = world;
+			fragUv = uv;
+			fragColor = color;
+		}
+	)";
+
+	const char* fragmentShaderSource = R"(
+		#version 330 core
+
+		in vec3 fragWorld;
+		in vec2 fragUv;
+		in vec4 fragColor;
+
+		out vec4 outColor;
+
+		const vec3 lightDirection = normalize(vec3(0.4, 0.8, 0.6));
+
+		void main() {
+			// the generators don't output normals, so shade flat with the face normal
+			vec3 normal = normalize(cross(dFdx(fragWorld), dFdy(fragWorld)));
+			float light = 0.35 + 0.65 * max(dot(normal, lightDirection), 0.0);
+
+			outColor = vec4(fragColor.rgb * light, fragColor.a);
+		}
+	)";
+
+	program = ShaderProgramBuilder()
+		.vertex(vertexShaderSource)
+		.fragment(fragmentShaderSource)
+		.build()
+		.compile();
+}
+
+void MeshProgram::free() {
+	program.free();
+}
+
+void MeshProgram::use(const mat4& view, const mat4& proj) {
+	program.use();
+	program.setf16("view", view);
+	program.setf16("proj", proj);
+	program.seti("instances", 0);
+}
+
+void MeshProgram::setInstanceOffset(int offset) {
+	program.seti("instanceOffset", offset);
+}
+
+void MeshRenderer::create() {
+	program.create();
+
+	glGenBuffers(1, &instanceBuffer);
+	glGenTextures(1, &instanceTexture);
+}
+
+void MeshRenderer::free() {
+	program.free();
+
+	glDeleteBuffers(1, &instanceBuffer);
+	glDeleteTextures(1, &instanceTexture);
+	instanceBuffer = 0;
+	instanceTexture = 0;
+}
+
+void MeshRenderer::clear() {
+	// keep the batches so their memory is reused next frame
+	for (Batch& batch : batches) {
+		batch.x.clear();
+		batch.y.clear();
+		batch.z.clear();
+		batch.radius.clear();
+		batch.instances.clear();
+	}
+}
+
+MeshRenderer::Batch& MeshRenderer::getBatch(const CachedMesh& mesh) {
+	if (meshGeneration != lithMeshCacheGeneration()) {
+		meshGeneration = lithMeshCacheGeneration();
+
+		batches.clear();
+		batchIndex.clear();
+		lastBatch = -1;
+	}
+
+	// instances of the same mesh are usually added together
+	if (lastBatch >= 0 && batches[lastBatch].mesh == &mesh) {
+		return batches[lastBatch];
+	}
+
+	auto [itr, inserted] = batchIndex.insert({ &mesh, (int)batches.size() });
+	if (inserted) {
+		batches.emplace_back().mesh = &mesh;
+	}
+
+	lastBatch = itr->second;
+	return batches[lastBatch];
+}
+
+void MeshRenderer::addMesh(const CachedMesh& mesh, const MeshInstance& instance) {
+	Batch& batch = getBatch(mesh);
+
+	float scale = max(abs(instance.scale.x), max(abs(instance.scale.y), abs(instance.scale.z)));
+
+	batch.x.push_back(instance.position.x);
+	batch.y.push_back(instance.position.y);
+	batch.z.push_back(instance.position.z);
+	batch.radius.push_back(mesh.radius * scale);
+	batch.instances.push_back(instance);
+}
+
+const MeshRenderStats& MeshRenderer::stats() const {
+	return lastStats;
+}
+
+// Test a range of bounding spheres against the frustum planes. Each plane is a separate
+// pass over the arrays so the inner loop is simple enough for the compiler to vectorize.
+static void cullRange(const vec4* planes, const float* x, const float* y, const float* z, const float* radius, uint8_t* visible, int count) {
+	for (int i = 0; i < count; i++) {
+		visible[i] = 1;
+	}
+
+	for (int p = 0; p < 6; p++) {
+		const float a = planes[p].x;
+		const float b = planes[p].y;
+		const float c = planes[p].z;
+		const float d = planes[p].w;
+
+		for (int i = 0; i < count; i++) {
+			float distance = a * x[i] + b * y[i] + c * z[i] + d;
+			visible[i] &= (uint8_t)(distance >= -radius[i]);
+		}
+	}
+}
+
+void MeshRenderer::cull(const mat4& viewProj, JobExecutor* jobs) {
+	LITH_PROFILE_SCOPE("cull");
+
+	// planes from the rows of the view projection matrix, pointing inwards
+
+	vec4 rows[4];
+	for (int i = 0; i < 4; i++) {
+		rows[i] = vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+	}
+
+	vec4 planes[6] = {
+		rows[3] + rows[0], rows[3] - rows[0],
+		rows[3] + rows[1], rows[3] - rows[1],
+		rows[3] + rows[2], rows[3] - rows[2]
+	};
+
+	for (vec4& plane : planes) {
+		plane /= length(vec3(plane));
+	}
+
+	struct Range {
+		Batch* batch;
+		int begin;
+		int count;
+	};
+
+	std::vector<Range> ranges;
+	int total = 0;
+
+	for (Batch& batch : batches) {
+		int count = (int)batch.instances.size();
+		batch.visible.resize(count);
+		total += count;
+
+		for (int begin = 0; begin < count; begin += MeshCullChunk) {
+			ranges.push_back({ &batch, begin, std::min(count - begin, MeshCullChunk) });
+		}
+	}
+
+	auto cullOne = [&](const Range& range) {
+		Batch& batch = *range.batch;
+		int begin = range.begin;
+
+		cullRange(planes, batch.x.data() + begin, batch.y.data() + begin, batch.z.data() + begin,
+			batch.radius.data() + begin, batch.visible.data() + begin, range.count);
+	};
+
+	if (!jobs || total < MeshCullParallelCount) {
+		for (const Range& range : ranges) {
+			cullOne(range);
+		}
+
+		return;
+	}
+
+	JobWait wait;
+
+	JobTree& tree = jobs->CreateTree();
+
+	wait.After(tree.CreateEmpty().For(ranges, cullOne));
+
+	jobs->Run(tree);
+	wait.Wait();
+}
+
+void MeshRenderer::draw(const mat4& view, const mat4& proj, JobExecutor* jobs) {
+	lastStats = {};
+
+	for (const Batch& batch : batches) {
+		lastStats.instanceCount += (int)batch.instances.size();
+	}
+
+	if (lastStats.instanceCount == 0) {
+		return;
+	}
+
+	cull(proj * view, jobs);
+
+	// Gather the visible instances into one upload, opaque first grouped by mesh,
+	// then the transparent ones sorted back to front
+
+	struct Run {
+		const CachedMesh* mesh;
+		int offset;
+		int count;
+	};
+
+	std::vector<Run> runs;
+	upload.clear();
+	transparent.clear();
+
+	vec4 depthRow = vec4(view[0][2], view[1][2], view[2][2], view[3][2]);
+
+	for (int b = 0; b < (int)batches.size(); b++) {
+		const Batch& batch = batches[b];
+		int offset = (int)upload.size();
+
+		for (int i = 0; i < (int)batch.instances.size(); i++) {
+			if (!batch.visible[i]) {
+				continue;
+			}
+
+			const MeshInstance& instance = batch.instances[i];
+
+			if (instance.color.a < 1.f) {
+				// view space z, more negative is further away
+				float depth = dot(depthRow, vec4(vec3(instance.position), 1.f));
+				transparent.push_back({ depth, b, i });
+			}
+
+			else {
+				upload.push_back(instance);
+			}
+		}
+
+		if ((int)upload.size() > offset) {
+			runs.push_back({ batch.mesh, offset, (int)upload.size() - offset });
+		}
+	}
+
+	int opaqueRuns = (int)runs.size();
+
+	std::sort(transparent.begin(), transparent.end(), [](const Transparent& a, const Transparent& b) {
+		return a.depth < b.depth;
+	});
+
+	for (const Transparent& t : transparent) {
+		const Batch& batch = batches[t.batch];
+
+		if ((int)runs.size() == opaqueRuns || runs.back().mesh != batch.mesh) {
+			runs.push_back({ batch.mesh, (int)upload.size(), 0 });
+		}
+
+		upload.push_back(batch.instances[t.instance]);
+		runs.back().count += 1;
+	}
+
+	lastStats.visibleCount = (int)upload.size();
+	lastStats.drawCount = (int)runs.size();
+
+	if (upload.size() == 0) {
+		return;
+	}
+
+	// orphan the old storage so this doesn't wait for last frame's draws
+	glBindBuffer(GL_TEXTURE_BUFFER, instanceBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, upload.size() * sizeof(MeshInstance), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_TEXTURE_BUFFER, 0, upload.size() * sizeof(MeshInstance), upload.data());
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_BUFFER, instanceTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, instanceBuffer);
+
+	glEnable(GL_DEPTH_TEST);
+	glDepthMask(GL_TRUE);
+	glDisable(GL_BLEND);
+
+	program.use(view, proj);
+
+	for (int r = 0; r < (int)runs.size(); r++) {
+		if (r == opaqueRuns) {
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			glDepthMask(GL_FALSE);
+		}
+
+		program.setInstanceOffset(runs[r].offset);
+		runs[r].mesh->mesh.drawInstanced(runs[r].count);
+	}
+
+	glDepthMask(GL_TRUE);
+	glDisable(GL_DEPTH_TEST);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
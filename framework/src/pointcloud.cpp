@@ -0,0 +1,409 @@
+#include "lith/pointcloud.h"
+#include "lith/job.h"
+#include "lith/profile.h"
+#include "gl/glad.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+// points binned by one job
+constexpr int PointChunkSize = 1 << 18;
+
+// below this, binning on the calling thread is faster than waking the jobs
+constexpr int PointBinParallelCount = 2 * PointChunkSize;
+
+PointVertex makePoint(vec3 position, float size, vec4 color) {
+	PointVertex point;
+	point.pos = position;
+	point.size = size;
+
+	for (int i = 0; i < 4; i++) {
+		point.color[i] = (uint8_t)(clamp(color[i], 0.f, 1.f) * 255.f + .5f);
+	}
+
+	return point;
+}
+
+// spread the low 16 bits out to the even bits, so x and y can be interleaved
+static uint32_t spreadBits(uint32_t x) {
+	x &= 0xffff;
+	x = (x | (x << 8)) & 0x00ff00ff;
+	x = (x | (x << 4)) & 0x0f0f0f0f;
+	x = (x | (x << 2)) & 0x33333333;
+	x = (x | (x << 1)) & 0x55555555;
+	return x;
+}
+
+// Sort the points of a chunk by the cell they're in on the finest grid, as a z-order curve so
+// each cell of a coarser grid is a run. A point is the first in its cell at every level below
+// the one where it splits from the point before it. Then they're grouped by that level, so the
+// points of each level come after the ones of the level before.
+static void binChunk(const PointVertex* points, PointCloud::Chunk& chunk, PointVertex* out) {
+	int count = chunk.count;
+
+	vec3 lo = points[0].pos;
+	vec3 hi = points[0].pos;
+
+	for (int i = 1; i < count; i++) {
+		lo = min(lo, points[i].pos);
+		hi = max(hi, points[i].pos);
+	}
+
+	chunk.min = lo;
+	chunk.max = hi;
+
+	// square cells over the longer side
+	const int cells = 1 << PointLevelCount;
+	float extent = max(hi.x - lo.x, hi.y - lo.y);
+	float toCell = extent > 0.f ? cells / extent : 0.f;
+
+	// the cell in the high half, the index in the low half
+	std::vector<uint64_t> keys(count);
+
+	for (int i = 0; i < count; i++) {
+		vec3 p = points[i].pos;
+
+		uint32_t x = (uint32_t)min((p.x - lo.x) * toCell, cells - 1.f);
+		uint32_t y = (uint32_t)min((p.y - lo.y) * toCell, cells - 1.f);
+		uint32_t cell = spreadBits(x) | spreadBits(y) << 1;
+
+		keys[i] = (uint64_t)cell << 32 | (uint32_t)i;
+	}
+
+	std::sort(keys.begin(), keys.end());
+
+	std::vector<uint8_t> levels(count);
+	int levelCounts[PointLevelCount + 2] = {};
+
+	for (int s = 0; s < count; s++) {
+		int level = 0;
+
+		if (s > 0) {
+			uint32_t split = (uint32_t)(keys[s] >> 32) ^ (uint32_t)(keys[s - 1] >> 32);
+
+			// each level is two bits of the cell, from the top
+			level = split == 0
+				? PointLevelCount + 1
+				: PointLevelCount - (std::bit_width(split) - 1) / 2;
+		}
+
+		levels[s] = (uint8_t)level;
+		levelCounts[level] += 1;
+	}
+
+	int offsets[PointLevelCount + 2];
+	int total = 0;
+
+	for (int level = 0; level < PointLevelCount + 2; level++) {
+		offsets[level] = total;
+		total += levelCounts[level];
+		chunk.levels[level] = total;
+	}
+
+	for (int s = 0; s < count; s++) {
+		out[offsets[levels[s]]++] = points[(uint32_t)keys[s]];
+	}
+}
+
+PointCloud::PointCloud()
+	: vertexArray (0)
+	, buffer      (0)
+	, capacity    (0)
+	, pointCount  (0)
+{}
+
+void PointCloud::create() {
+	glGenVertexArrays(1, &vertexArray);
+}
+
+void PointCloud::free() {
+	glDeleteBuffers(1, &buffer);
+	glDeleteVertexArrays(1, &vertexArray);
+
+	buffer = 0;
+	vertexArray = 0;
+	capacity = 0;
+	pointCount = 0;
+
+	chunks.clear();
+}
+
+void PointCloud::reserve(int newCapacity) {
+	GLuint grown;
+	glGenBuffers(1, &grown);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)newCapacity * sizeof(PointVertex), nullptr, GL_STATIC_DRAW);
+
+	if (buffer) {
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)pointCount * sizeof(PointVertex));
+		glDeleteBuffers(1, &buffer);
+	}
+
+	buffer = grown;
+	capacity = newCapacity;
+
+	// the attributes read from the buffer which was bound when they were set
+	glBindVertexArray(vertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PointVertex), (void*)offsetof(PointVertex, pos));
+	glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(PointVertex), (void*)offsetof(PointVertex, size));
+	glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PointVertex), (void*)offsetof(PointVertex, color));
+
+	glBindVertexArray(0);
+}
+
+void PointCloud::append(const PointVertex* points, int count, JobExecutor* jobs) {
+	if (count <= 0) {
+		return;
+	}
+
+	LITH_PROFILE_SCOPE("bin points");
+
+	int first = pointCount;
+
+	std::vector<Chunk> added;
+	for (int begin = 0; begin < count; begin += PointChunkSize) {
+		Chunk& chunk = added.emplace_back();
+		chunk.first = first + begin;
+		chunk.count = std::min(count - begin, PointChunkSize);
+	}
+
+	std::vector<PointVertex> binned(count);
+
+	auto binOne = [&](Chunk& chunk) {
+		int begin = chunk.first - first;
+		binChunk(points + begin, chunk, binned.data() + begin);
+	};
+
+	if (!jobs || count < PointBinParallelCount) {
+		for (Chunk& chunk : added) {
+			binOne(chunk);
+		}
+	}
+
+	else {
+		JobWait wait;
+
+		JobTree& tree = jobs->CreateTree();
+
+		wait.After(tree.CreateEmpty().For(added, binOne));
+
+		jobs->Run(tree);
+		wait.Wait();
+	}
+
+	if (pointCount + count > capacity) {
+		reserve(std::max(capacity * 2, pointCount + count));
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)first * sizeof(PointVertex), (GLsizeiptr)count * sizeof(PointVertex), binned.data());
+
+	pointCount += count;
+	chunks.insert(chunks.end(), added.begin(), added.end());
+}
+
+void PointCloud::clear() {
+	pointCount = 0;
+	chunks.clear();
+}
+
+int PointCloud::size() const {
+	return pointCount;
+}
+
+const std::vector<PointCloud::Chunk>& PointCloud::getChunks() const {
+	return chunks;
+}
+
+int PointCloud::draw(const CameraLens& lens, int viewportHeight, const Transform2D& transform) const {
+	if (pointCount == 0 || viewportHeight <= 0) {
+		return 0;
+	}
+
+	mat4 viewProj = lens.GetProjectionMatrix() * lens.GetViewMatrix();
+
+	// world units across a pixel, perspective cameras measure it at the nearest point of each chunk
+	float orthoPixel = lens.ortho ? lens.height / viewportHeight : 0.f;
+	float perspectivePixel = lens.ortho ? 0.f : 2.f * tan(lens.fovy / 2.f) / viewportHeight;
+	float scale = max(transform.scaleFactor(), 1e-6f);
+
+	std::vector<GLint> firsts;
+	std::vector<GLsizei> counts;
+
+	for (const Chunk& chunk : chunks) {
+		// skip chunks with every corner outside of the same plane
+		int outside[6] = {};
+		vec3 center = vec3(0.f);
+
+		for (int c = 0; c < 8; c++) {
+			vec3 local = vec3(c & 1 ? chunk.max.x : chunk.min.x, c & 2 ? chunk.max.y : chunk.min.y, c & 4 ? chunk.max.z : chunk.min.z);
+			vec3 world = vec3(transform.apply(vec2(local)), local.z);
+			vec4 clip = viewProj * vec4(world, 1.f);
+
+			outside[0] += clip.x < -clip.w;
+			outside[1] += clip.x >  clip.w;
+			outside[2] += clip.y < -clip.w;
+			outside[3] += clip.y >  clip.w;
+			outside[4] += clip.z < -clip.w;
+			outside[5] += clip.z >  clip.w;
+
+			center += world / 8.f;
+		}
+
+		if (std::find(outside, outside + 6, 8) != outside + 6) {
+			continue;
+		}
+
+		float pixel = orthoPixel;
+
+		if (!lens.ortho) {
+			float radius = length(vec2(chunk.max - chunk.min)) * scale / 2.f;
+			pixel = perspectivePixel * max(length(center - lens.position) - radius, lens.near);
+		}
+
+		// the coarsest level with cells no bigger than a pixel
+		float extent = max(chunk.max.x - chunk.min.x, chunk.max.y - chunk.min.y);
+		float cellsPerPixel = extent * scale / max(pixel, 1e-9f);
+
+		int level = cellsPerPixel > 1.f ? (int)ceil(log2(cellsPerPixel)) : 0;
+		level = std::min(level, PointLevelCount + 1);
+
+		firsts.push_back(chunk.first);
+		counts.push_back(chunk.levels[level]);
+	}
+
+	if (firsts.empty()) {
+		return 0;
+	}
+
+	glBindVertexArray(vertexArray);
+	glMultiDrawArrays(GL_POINTS, firsts.data(), counts.data(), (GLsizei)firsts.size());
+	glBindVertexArray(0);
+
+	int drawn = 0;
+	for (GLsizei count : counts) {
+		drawn += count;
+	}
+
+	return drawn;
+}
+
+void PointCloudProgram::create() {
+	const char* vertexShaderSource = R"(
+		#version 330 core
+
+		layout (location = 0) in vec3 pos;
+		layout (location = 1) in float size;
+		layout (location = 2) in vec4 color;
+
+		uniform mat4 view;
+		uniform mat4 proj;
+
+		// the 2D transform of the cloud
+		uniform vec2 axisX;
+		uniform vec2 axisY;
+		uniform vec2 origin;
+
+		out vec4 fragColor;
+		out float fragSize;
+
+		void main() {
+			vec2 world = axisX * pos.x + axisY * pos.y + origin;
+
+			gl_Position = proj * view * vec4(world, pos.z, 1.0);
+			gl_PointSize = max(size, 1.0);
+			fragColor = color;
+			fragSize = gl_PointSize;
+		}
+	)";
+
+	// Round points with an anti-aliased edge, the small ones are squares
+	const char* fragmentShaderSource = R"(
+		#version 330 core
+
+		in vec4 fragColor;
+		in float fragSize;
+
+		out vec4 outColor;
+
+		void main() {
+			float r = length(gl_PointCoord * 2.0 - 1.0);
+			float coverage = fragSize < 3.0 ? 1.0 : clamp((1.0 - r) * fragSize * 0.5, 0.0, 1.0);
+
+			if (coverage <= 0.0) {
+				discard;
+			}
+
+			outColor = vec4(fragColor.rgb, fragColor.a * coverage);
+		}
+	)";
+
+	program = ShaderProgramBuilder()
+		.vertex(vertexShaderSource)
+		.fragment(fragmentShaderSource)
+		.build()
+		.compile();
+}
+
+void PointCloudProgram::free() {
+	program.free();
+}
+
+void PointCloudProgram::use(const mat4& view, const mat4& proj, const Transform2D& transform) {
+	program.use();
+	program.setf16("view", view);
+	program.setf16("proj", proj);
+	program.setf2("axisX", transform.axisX);
+	program.setf2("axisY", transform.axisY);
+	program.setf2("origin", transform.origin);
+}
+
+void PointCloudRenderer::create() {
+	program.create();
+}
+
+void PointCloudRenderer::free() {
+	program.free();
+}
+
+void PointCloudRenderer::draw(const CameraLens& lens, int viewportHeight) {
+	lastStats = {};
+
+	if (items.empty()) {
+		return;
+	}
+
+	mat4 view = lens.GetViewMatrix();
+	mat4 proj = lens.GetProjectionMatrix();
+
+	glEnable(GL_PROGRAM_POINT_SIZE);
+
+	for (const Item& item : items) {
+		program.use(view, proj, item.transform);
+
+		lastStats.pointCount += item.cloud->size();
+		lastStats.drawnCount += item.cloud->draw(lens, viewportHeight, item.transform);
+	}
+
+	glDisable(GL_PROGRAM_POINT_SIZE);
+}
+
+void PointCloudRenderer::clear() {
+	items.clear();
+}
+
+void PointCloudRenderer::addPointCloud(const PointCloud& cloud, const Transform2D& transform) {
+	items.push_back({ &cloud, transform });
+}
+
+const PointCloudRenderStats& PointCloudRenderer::stats() const {
+	return lastStats;
+}
@@ -0,0 +1,129 @@
+#include "lith/polygon.h"
+
+void PolygonMesh::create() {
+	mesh = VertexArrayBuilder()
+		.topology(TopologyTriangles)
+		.index().data(sizeof(uint32_t))
+		.buffer(0).data(sizeof(VertexData))
+			.host()
+		.map(0)
+			.attribute(0).type(AttributeTypeFloat, 3)
+			.attribute(1).type(AttributeTypeUByteNorm, 4)
+		.build();
+}
+
+void PolygonMesh::free() {
+	mesh.free();
+}
+
+void PolygonMesh::draw() {
+	mesh.upload().draw();
+}
+
+void PolygonMesh::clear() {
+	mesh.clear();
+}
+
+void PolygonMesh::addPolygon(const VertexData* vertices, int vertexCount, const uint32_t* indices, int indexCount) {
+	ByteVector& vertexData = mesh.bufferData(0);
+	ByteVector& indexData = mesh.indexData();
+
+	uint32_t base = (uint32_t)vertexData.count();
+	vertexData.addMany(vertices, vertexCount);
+
+	for (int i = 0; i < indexCount; i++) {
+		indexData.add(base + indices[i]);
+	}
+}
+
+void PolygonMesh::upload() {
+	mesh.upload();
+}
+
+void PolygonMesh::drawUploaded() const {
+	mesh.draw();
+}
+
+void PolygonMesh::setVertices(int first, const VertexData* vertices, int count) {
+	ByteVector& vertexData = mesh.bufferData(0);
+
+	for (int i = 0; i < count; i++) {
+		vertexData.at<VertexData>(first + i) = vertices[i];
+	}
+
+	mesh.uploadRange(0, first, count);
+}
+
+void PolygonProgram::create() {
+	const char* vertexShaderSource = R"(
+		#version 330 core
+
+		layout (location = 0) in vec3 pos;
+		layout (location = 1) in vec4 color;
+
+		uniform mat4 view;
+		uniform mat4 proj;
+
+		out vec4 fragColor;
+
+		void main() {
+			gl_Position = proj * view * vec4(pos, 1.0);
+			fragColor = color;
+		}
+	)";
+
+	const char* fragmentShaderSource = R"(
+		#version 330 core
+
+		in vec4 fragColor;
+		out vec4 outColor;
+
+		void main() {
+			outColor = fragColor;
+		}
+	)";
+
+	program = ShaderProgramBuilder()
+		.vertex(vertexShaderSource)
+		.fragment(fragmentShaderSource)
+		.build()
+		.compile();
+}
+
+void PolygonProgram::free() {
+	program.free();
+}
+
+void PolygonProgram::use(const mat4& view, const mat4& proj) {
+	program.use();
+	program.setf16("view", view);
+	program.setf16("proj", proj);
+}
+
+void PolygonRenderer::create() {
+	shader.create();
+	mesh.create();
+}
+
+void PolygonRenderer::free() {
+	shader.free();
+	mesh.free();
+}
+
+void PolygonRenderer::draw(const mat4& view, const mat4& proj) {
+	shader.use(view, proj);
+	mesh.draw();
+}
+
+void PolygonRenderer::drawMesh(const PolygonMesh& mesh, const mat4& view, const mat4& proj) {
+	shader.use(view, proj);
+	mesh.drawUploaded();
+}
+
+void PolygonRenderer::clear() {
+	mesh.clear();
+}
+
+void PolygonRenderer::addPolygon(const PolygonMesh::VertexData* vertices, int vertexCount, const uint32_t* indices, int indexCount) {
+	mesh.addPolygon(vertices, vertexCount, indices, indexCount);
+}
@@ -0,0 +1,357 @@
+#include "lith/profile.h"
+#include "gl/glad.h"
+
+#include <chrono>
+#include <fstream>
+
+static ProfileContext* ctx = nullptr;
+
+// each module (runtime and sketch plugin) has its own copy of these, they
+// cache the buffer of this thread from the context
+static thread_local ProfileThreadBuffer* t_buffer = nullptr;
+static thread_local ProfileContext* t_bufferContext = nullptr;
+
+ProfileContext::~ProfileContext() {
+	for (ProfileThreadBuffer* buffer : threads) {
+		delete buffer;
+	}
+}
+
+void registerProfileContext(ProfileContext* context) {
+	ctx = context;
+	ctx->namePointers.clear();
+}
+
+int64_t lithProfileTime() {
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static ProfileThreadBuffer* getThreadBuffer() {
+	if (t_bufferContext != ctx) {
+		std::scoped_lock lock(ctx->threadsMutex);
+
+		ProfileThreadBuffer*& buffer = ctx->threadBuffers[std::this_thread::get_id()];
+
+		if (!buffer) {
+			buffer = new ProfileThreadBuffer();
+			buffer->thread = (int)ctx->threads.size();
+			ctx->threads.push_back(buffer);
+		}
+
+		t_buffer = buffer;
+		t_bufferContext = ctx;
+	}
+
+	return t_buffer;
+}
+
+void lithProfileBegin(const char* name) {
+	if (!ctx || !ctx->enabled) {
+		return;
+	}
+
+	ProfileThreadBuffer* buffer = getThreadBuffer();
+
+	if (buffer->depth < ProfileMaxDepth) {
+		buffer->openName[buffer->depth] = name;
+		buffer->openBegin[buffer->depth] = lithProfileTime();
+	}
+
+	buffer->depth += 1;
+}
+
+void lithProfileEnd() {
+	if (!ctx) {
+		return;
+	}
+
+	ProfileThreadBuffer* buffer = getThreadBuffer();
+
+	// the profiler was enabled inside of this scope
+	if (buffer->depth == 0) {
+		return;
+	}
+
+	buffer->depth -= 1;
+
+	if (buffer->depth >= ProfileMaxDepth) {
+		return;
+	}
+
+	uint64_t head = buffer->head.load(std::memory_order_relaxed);
+
+	ProfileEvent& event = buffer->events[head % ProfileThreadCapacity];
+	event.name = buffer->openName[buffer->depth];
+	event.begin = buffer->openBegin[buffer->depth];
+	event.end = lithProfileTime();
+	event.depth = buffer->depth;
+
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+static GLuint allocQuery() {
+	if (ctx->gpuQueryPool.size() == 0) {
+		GLuint query;
+		glGenQueries(1, &query);
+		return query;
+	}
+
+	GLuint query = ctx->gpuQueryPool.back();
+	ctx->gpuQueryPool.pop_back();
+	return query;
+}
+
+static int internName(const char* name) {
+	auto pointer = ctx->namePointers.find(name);
+	if (pointer != ctx->namePointers.end()) {
+		return pointer->second;
+	}
+
+	auto [itr, inserted] = ctx->nameIndex.insert({ name, (int)ctx->names.size() });
+	if (inserted) {
+		ctx->names.push_back(name);
+	}
+
+	ctx->namePointers[name] = itr->second;
+	return itr->second;
+}
+
+static ProfileFrame* findFrame(int64_t id) {
+	ProfileFrame& frame = ctx->frames[id % ProfileFrameCount];
+	return frame.id == id ? &frame : nullptr;
+}
+
+// Read back the queries of a frame, this blocks if the GPU hasn't finished them
+static void resolveGPUFrame(ProfileGPUFrame& gpu) {
+	ProfileFrame* frame = findFrame(gpu.id);
+
+	for (const ProfileGPUQuery& query : gpu.queries) {
+		// never ended
+		if (query.end == 0) {
+			ctx->gpuQueryPool.push_back(query.begin);
+			continue;
+		}
+
+		GLuint64 begin = 0;
+		GLuint64 end = 0;
+		glGetQueryObjectui64v(query.begin, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(query.end, GL_QUERY_RESULT, &end);
+
+		if (frame) {
+			ProfileFrameEvent event;
+			event.name = internName(query.name);
+			event.thread = ProfileGPUThread;
+			event.depth = query.depth;
+			event.begin = (int64_t)begin - gpu.gpuTime + gpu.cpuTime;
+			event.end = (int64_t)end - gpu.gpuTime + gpu.cpuTime;
+
+			frame->events.push_back(event);
+		}
+
+		ctx->gpuQueryPool.push_back(query.begin);
+		ctx->gpuQueryPool.push_back(query.end);
+	}
+
+	gpu.queries.clear();
+	gpu.id = -1;
+}
+
+static ProfileGPUFrame& getGPUFrame() {
+	ProfileGPUFrame& gpu = ctx->gpuFrames[ctx->frameId % ProfileGPULatency];
+
+	if (gpu.id != ctx->frameId) {
+		if (gpu.id >= 0) {
+			resolveGPUFrame(gpu);
+		}
+
+		GLint64 gpuTime = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+
+		gpu.id = ctx->frameId;
+		gpu.gpuTime = gpuTime;
+		gpu.cpuTime = lithProfileTime();
+	}
+
+	return gpu;
+}
+
+void lithProfileBeginGPU(const char* name) {
+	if (!ctx || !ctx->enabled || !glQueryCounter) {
+		return;
+	}
+
+	ProfileGPUFrame& gpu = getGPUFrame();
+
+	ProfileGPUQuery query;
+	query.name = name;
+	query.depth = (int)ctx->gpuOpen.size();
+	query.begin = allocQuery();
+	query.end = 0;
+
+	glQueryCounter(query.begin, GL_TIMESTAMP);
+
+	ctx->gpuOpen.push_back((int)gpu.queries.size());
+	gpu.queries.push_back(query);
+}
+
+void lithProfileEndGPU() {
+	if (!ctx || ctx->gpuOpen.size() == 0) {
+		return;
+	}
+
+	ProfileGPUFrame& gpu = getGPUFrame();
+
+	int index = ctx->gpuOpen.back();
+	ctx->gpuOpen.pop_back();
+
+	// the frame ended between begin and end
+	if (index >= (int)gpu.queries.size()) {
+		return;
+	}
+
+	ProfileGPUQuery& query = gpu.queries[index];
+	query.end = allocQuery();
+
+	glQueryCounter(query.end, GL_TIMESTAMP);
+}
+
+void lithProfileFrame() {
+	if (!ctx) {
+		return;
+	}
+
+	int64_t now = lithProfileTime();
+
+	ProfileFrame& frame = ctx->frames[ctx->frameId % ProfileFrameCount];
+	frame.id = ctx->frameId;
+	frame.begin = ctx->frameBegin;
+	frame.end = now;
+	frame.events.clear();
+
+	ctx->mainThread = getThreadBuffer()->thread;
+	frame.thread = ctx->mainThread;
+
+	{
+		std::scoped_lock lock(ctx->threadsMutex);
+
+		for (ProfileThreadBuffer* buffer : ctx->threads) {
+			uint64_t head = buffer->head.load(std::memory_order_acquire);
+
+			if (head - buffer->tail > ProfileThreadCapacity) {
+				buffer->tail = head - ProfileThreadCapacity;
+			}
+
+			for (uint64_t i = buffer->tail; i < head; i++) {
+				const ProfileEvent& e = buffer->events[i % ProfileThreadCapacity];
+
+				ProfileFrameEvent event;
+				event.name = internName(e.name);
+				event.thread = buffer->thread;
+				event.depth = e.depth;
+				event.begin = e.begin;
+				event.end = e.end;
+
+				frame.events.push_back(event);
+			}
+
+			buffer->tail = head;
+		}
+	}
+
+	ctx->frameId += 1;
+	ctx->frameBegin = now;
+
+	// Read back the oldest GPU frame if it's ready. If not, getGPUFrame
+	// will wait for it when the slot is reused.
+
+	ProfileGPUFrame& oldest = ctx->gpuFrames[ctx->frameId % ProfileGPULatency];
+
+	if (oldest.id >= 0 && oldest.queries.size() > 0 && oldest.queries.back().end != 0) {
+		GLint available = 0;
+		glGetQueryObjectiv(oldest.queries.back().end, GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (available) {
+			resolveGPUFrame(oldest);
+		}
+	}
+}
+
+const ProfileFrame* lithProfileGetFrame(int framesAgo) {
+	if (!ctx || framesAgo < 0) {
+		return nullptr;
+	}
+
+	return findFrame(ctx->frameId - 1 - framesAgo);
+}
+
+const char* lithProfileGetName(int name) {
+	return ctx->names.at(name).c_str();
+}
+
+static void writeJsonString(std::ofstream& out, const std::string& str) {
+	out << '"';
+	for (char c : str) {
+		if (c == '"' || c == '\\') {
+			out << '\\';
+		}
+		out << c;
+	}
+	out << '"';
+}
+
+bool lithProfileWriteChromeTrace(const char* filepath) {
+	if (!ctx) {
+		return false;
+	}
+
+	std::ofstream out(filepath);
+	if (!out.is_open()) {
+		return false;
+	}
+
+	int64_t base = -1;
+	bool first = true;
+
+	out << "{\"traceEvents\":[\n";
+
+	for (int i = ProfileFrameCount - 1; i >= 0; i--) {
+		const ProfileFrame* frame = lithProfileGetFrame(i);
+
+		if (!frame) {
+			continue;
+		}
+
+		if (base < 0) {
+			base = frame->begin;
+		}
+
+		for (const ProfileFrameEvent& event : frame->events) {
+			if (!first) {
+				out << ",\n";
+			}
+
+			first = false;
+
+			out << "{\"name\":";
+			writeJsonString(out, ctx->names[event.name]);
+			out << ",\"cat\":\"" << (event.thread == ProfileGPUThread ? "gpu" : "cpu") << "\""
+				<< ",\"ph\":\"X\""
+				<< ",\"ts\":" << (event.begin - base) / 1000.0
+				<< ",\"dur\":" << (event.end - event.begin) / 1000.0
+				<< ",\"pid\":0"
+				<< ",\"tid\":" << (event.thread == ProfileGPUThread ? 1000 : event.thread)
+				<< "}";
+		}
+	}
+
+	if (!first) {
+		out << ",\n";
+	}
+
+	out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << ctx->mainThread << ",\"args\":{\"name\":\"main\"}},\n";
+	out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1000,\"args\":{\"name\":\"gpu\"}}\n";
+	out << "]}\n";
+
+	return true;
+}
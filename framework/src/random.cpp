@@ -1,16 +1,80 @@
 #include "lith/random.h"
-#include <random>
-#include <limits.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+
+// 8 xoshiro256** generators stored by state word instead of by generator,
+// so each step is a handful of loops over 8 lanes which vectorize
+constexpr int RandomLanes = 8;
+
+struct RandomLaneState {
+	uint64_t s0[RandomLanes];
+	uint64_t s1[RandomLanes];
+	uint64_t s2[RandomLanes];
+	uint64_t s3[RandomLanes];
+};
+
+struct RandomThread {
+	Xoshiro256ss engine;
+	RandomLaneState lanes;
+	int stream = -1;
+	int generation = -1;
+};
+
+static std::atomic<uint64_t> s_seed = 0;
+static std::atomic<int> s_generation = 0;
+static std::atomic<int> s_nextStream = 1;
+
+static thread_local RandomThread t_random;
+
+static void reseed(RandomThread& random, int stream) {
+	random.stream = stream;
+	random.generation = s_generation.load(std::memory_order_acquire);
+
+	SplitMix64 mix(s_seed.load(std::memory_order_relaxed));
+	random.engine.seed(mix() ^ ((uint64_t)stream * 0x9e3779b97f4a7c15ull));
+
+	// the lanes start 2^128 calls apart from the engine and each other
+	Xoshiro256ss lane = random.engine;
+	for (int i = 0; i < RandomLanes; i++) {
+		lane.jump();
+		random.lanes.s0[i] = lane.s[0];
+		random.lanes.s1[i] = lane.s[1];
+		random.lanes.s2[i] = lane.s[2];
+		random.lanes.s3[i] = lane.s[3];
+	}
+}
+
+static RandomThread& getThread() {
+	RandomThread& random = t_random;
+
+	if (random.generation != s_generation.load(std::memory_order_relaxed)) {
+		reseed(random, random.stream >= 0 ? random.stream : s_nextStream.fetch_add(1));
+	}
 
-static std::mt19937 g_random;
-static std::uniform_int_distribution<int> dist(0, INT_MAX);
+	return random;
+}
 
-int _rand() {
-    return dist(g_random);
+static int _rand() {
+	return (int)(getThread().engine() >> 33);
 }
 
 void rand_seed(int seed) {
-	g_random.seed(seed);
+	s_seed = (uint64_t)seed;
+	s_generation += 1;
+	s_nextStream = 1;
+
+	reseed(t_random, 0);
+}
+
+void rand_stream(int stream) {
+	getThread();
+	reseed(t_random, stream);
+}
+
+Xoshiro256ss& rand_engine() {
+	return getThread().engine;
 }
 
 int rand_i() {
@@ -22,7 +86,7 @@ bool rand_b() {
 }
 
 float rand_f() {
-    return _rand() / (float)dist.max();
+    return (getThread().engine() >> 40) * 0x1.0p-24f;
 }
 
 vec2 rand_2f() {
@@ -57,7 +121,9 @@ int rand_im(int max) {
     if (max == 0)
         return 0;
 
-    return _rand() % max;
+    // multiply instead of modulo, it's faster and unbiased enough for 32 bit ranges
+    uint64_t range = (uint64_t)std::abs((int64_t)max);
+    return (int)(((getThread().engine() >> 32) * range) >> 32);
 }
 
 float rand_fm(float max) {
@@ -240,4 +306,132 @@ vec2 rand_outside_box(float extentX, float extentY, float paddingX, float paddin
 	}
 
 	return insidePadding;
-}
\ No newline at end of file
+}
+
+// Bulk
+
+static void fillBits(RandomLaneState& lanes, uint32_t* out, int count) {
+	for (int begin = 0; begin < count; begin += RandomLanes * 2) {
+		uint64_t result[RandomLanes];
+
+		for (int i = 0; i < RandomLanes; i++) {
+			result[i] = Xoshiro256ss::rotl(lanes.s1[i] * 5, 7) * 9;
+		}
+
+		for (int i = 0; i < RandomLanes; i++) {
+			uint64_t t = lanes.s1[i] << 17;
+
+			lanes.s2[i] ^= lanes.s0[i];
+			lanes.s3[i] ^= lanes.s1[i];
+			lanes.s1[i] ^= lanes.s2[i];
+			lanes.s0[i] ^= lanes.s3[i];
+			lanes.s2[i] ^= t;
+			lanes.s3[i] = Xoshiro256ss::rotl(lanes.s3[i], 45);
+		}
+
+		for (int i = 0; i < RandomLanes; i++) {
+			out[begin + i * 2 + 0] = (uint32_t)(result[i] >> 32);
+			out[begin + i * 2 + 1] = (uint32_t)result[i];
+		}
+	}
+}
+
+// Generate 'count' random words in chunks and pass them to write(offset, bits, size)
+template<typename _write>
+static void generate(size_t count, _write&& write) {
+	constexpr int chunk = 256;
+
+	RandomLaneState& lanes = getThread().lanes;
+	uint32_t bits[chunk];
+
+	for (size_t offset = 0; offset < count; offset += chunk) {
+		int size = (int)std::min(count - offset, (size_t)chunk);
+		int rounded = (size + RandomLanes * 2 - 1) / (RandomLanes * 2) * (RandomLanes * 2);
+
+		fillBits(lanes, bits, rounded);
+		write(offset, bits, size);
+	}
+}
+
+// Fill with floats in [min, min + extent)
+static void fillFloats(float* out, size_t count, float min, float extent) {
+	generate(count, [&](size_t offset, const uint32_t* bits, int size) {
+		float* o = out + offset;
+		for (int i = 0; i < size; i++) {
+			o[i] = min + (float)(bits[i] >> 8) * (0x1.0p-24f * extent);
+		}
+	});
+}
+
+static_assert(sizeof(vec2) == sizeof(float) * 2 && sizeof(vec3) == sizeof(float) * 3, "vectors must be tightly packed");
+
+void rand_fill_f(std::span<float> out) {
+	fillFloats(out.data(), out.size(), 0.f, 1.f);
+}
+
+void rand_fill_fmm(std::span<float> out, float min, float max) {
+	fillFloats(out.data(), out.size(), min, max - min);
+}
+
+void rand_fill_im(std::span<int> out, int max) {
+	uint64_t range = (uint64_t)std::abs((int64_t)max);
+
+	generate(out.size(), [&](size_t offset, const uint32_t* bits, int size) {
+		int* o = out.data() + offset;
+		for (int i = 0; i < size; i++) {
+			o[i] = (int)((bits[i] * range) >> 32);
+		}
+	});
+}
+
+void rand_2f_n(std::span<vec2> out) {
+	fillFloats((float*)out.data(), out.size() * 2, 0.f, 1.f);
+}
+
+void rand_2fmm_n(std::span<vec2> out, vec2 min, vec2 max) {
+	fillFloats((float*)out.data(), out.size() * 2, 0.f, 1.f);
+
+	for (vec2& v : out) {
+		v = min + v * (max - min);
+	}
+}
+
+void rand_3fmm_n(std::span<vec3> out, vec3 min, vec3 max) {
+	fillFloats((float*)out.data(), out.size() * 3, 0.f, 1.f);
+
+	for (vec3& v : out) {
+		v = min + v * (max - min);
+	}
+}
+
+// Same distribution as rand_2fcn / rand_3fcn, normalized points in a box
+
+void rand_2fcn_n(std::span<vec2> out, float radius) {
+	float* f = (float*)out.data();
+	fillFloats(f, out.size() * 2, -1.f, 2.f);
+
+	for (size_t i = 0; i < out.size(); i++) {
+		float x = f[i * 2 + 0];
+		float y = f[i * 2 + 1];
+		float scale = radius / std::sqrt(std::max(x * x + y * y, 1e-12f));
+
+		f[i * 2 + 0] = x * scale;
+		f[i * 2 + 1] = y * scale;
+	}
+}
+
+void rand_3fcn_n(std::span<vec3> out, float radius) {
+	float* f = (float*)out.data();
+	fillFloats(f, out.size() * 3, -1.f, 2.f);
+
+	for (size_t i = 0; i < out.size(); i++) {
+		float x = f[i * 3 + 0];
+		float y = f[i * 3 + 1];
+		float z = f[i * 3 + 2];
+		float scale = radius / std::sqrt(std::max(x * x + y * y + z * z, 1e-12f));
+
+		f[i * 3 + 0] = x * scale;
+		f[i * 3 + 1] = y * scale;
+		f[i * 3 + 2] = z * scale;
+	}
+}
@@ -0,0 +1,109 @@
+#include "lith/retained.h"
+
+static bool drawsShape(const RetainedShape& shape, const RetainedShape* target) {
+	for (const RenderCommandList::RetainedCommand& retained : shape.rest.retainedShapes) {
+		if (retained.shape == target || drawsShape(*retained.shape, target)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+RetainedShape::RetainedShape()
+	: lineCount          (0)
+	, shapeCount         (0)
+	, polygonVertexCount (0)
+	, created            (false)
+{}
+
+void RetainedShape::create(const RenderCommandList& commands) {
+	// drawing a shape which draws this one would never end. the shapes drawn into this one
+	// were checked when they were created, so only a cycle through this one is possible
+	for (const RenderCommandList::RetainedCommand& retained : commands.retainedShapes) {
+		if (retained.shape == this || drawsShape(*retained.shape, this)) {
+			throw nullptr;
+		}
+	}
+
+	free();
+
+	lines.create();
+	shapes.create();
+	polygons.create();
+
+	lines.addLines(commands.lines.data(), (int)commands.lines.size());
+	shapes.addShapes(commands.shapes.data(), (int)commands.shapes.size());
+	polygons.addPolygon(commands.polygonVertices.data(), (int)commands.polygonVertices.size(), commands.polygonIndices.data(), (int)commands.polygonIndices.size());
+
+	lines.upload();
+	shapes.upload();
+	polygons.upload();
+
+	rest.clear();
+	rest.texts = commands.texts;
+	rest.meshes = commands.meshes;
+	rest.pointClouds = commands.pointClouds;
+	rest.retainedShapes = commands.retainedShapes;
+
+	lineCount = (int)commands.lines.size();
+	shapeCount = (int)commands.shapes.size();
+	polygonVertexCount = (int)commands.polygonVertices.size();
+	created = true;
+}
+
+void RetainedShape::free() {
+	if (!created) {
+		return;
+	}
+
+	lines.free();
+	shapes.free();
+	polygons.free();
+	rest.clear();
+
+	lineCount = 0;
+	shapeCount = 0;
+	polygonVertexCount = 0;
+	created = false;
+}
+
+void RetainedShape::updateLines(int first, const LineMesh::InstanceVertexData* segments, int count) {
+	if (first < 0 || first + count > lineCount) {
+		throw nullptr;
+	}
+
+	lines.setLines(first, segments, count);
+}
+
+void RetainedShape::updateShapes(int first, const ShapeMesh::InstanceVertexData* shapes, int count) {
+	if (first < 0 || first + count > shapeCount) {
+		throw nullptr;
+	}
+
+	this->shapes.setShapes(first, shapes, count);
+}
+
+void RetainedShape::updatePolygonVertices(int first, const PolygonMesh::VertexData* vertices, int count) {
+	if (first < 0 || first + count > polygonVertexCount) {
+		throw nullptr;
+	}
+
+	polygons.setVertices(first, vertices, count);
+}
+
+int RetainedShape::getLineCount() const {
+	return lineCount;
+}
+
+int RetainedShape::getShapeCount() const {
+	return shapeCount;
+}
+
+int RetainedShape::getPolygonVertexCount() const {
+	return polygonVertexCount;
+}
+
+bool RetainedShape::isCreated() const {
+	return created;
+}
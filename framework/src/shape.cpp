@@ -0,0 +1,357 @@
+#include "lith/shape.h"
+#include "lith/profile.h"
+
+void ShapeMesh::create() {
+	QuadVertexData quad[4] = {
+		{ vec2(0, 0) },
+		{ vec2(0, 1) },
+		{ vec2(1, 1) },
+		{ vec2(1, 0) }
+	};
+
+	mesh = VertexArrayBuilder()
+		.topology(TopologyTriangles)
+		.index().data({0, 1, 2, 0, 3, 2})
+		.buffer(0).data(sizeof(QuadVertexData), sizeof(quad), quad)
+		.buffer(1).data(sizeof(InstanceVertexData))
+			.host()
+		.map(0)
+			.attribute(0).type(AttributeTypeFloat, 2)
+		.map(1)
+			.instanced()
+			.attribute(1).type(AttributeTypeFloat, 3)
+			.attribute(2).type(AttributeTypeFloat, 2)
+			.attribute(3).type(AttributeTypeFloat, 1)
+			.attribute(6).type(AttributeTypeFloat, 4)
+			.attribute(7).type(AttributeTypeUByteNorm, 4)
+			.attribute(8).type(AttributeTypeUByteNorm, 4)
+			.attribute(4).type(AttributeTypeHalf, 1)
+			.attribute(5).type(AttributeTypeUByte, 1)
+		.build();
+
+	instances = &mesh.buffer(1);
+}
+
+void ShapeMesh::free() {
+	mesh.free();
+}
+
+void ShapeMesh::draw() {
+	mesh.upload().draw();
+}
+
+void ShapeMesh::clear() {
+	mesh.clearInstances();
+}
+
+void ShapeMesh::addShape(const InstanceVertexData& shape) {
+	instances->data.add(shape);
+}
+
+void ShapeMesh::addShapes(const InstanceVertexData* shapes, int count) {
+	instances->data.addMany(shapes, count);
+}
+
+void ShapeMesh::upload() {
+	mesh.upload();
+}
+
+void ShapeMesh::drawUploaded() const {
+	mesh.draw();
+}
+
+void ShapeMesh::setShapes(int first, const InstanceVertexData* shapes, int count) {
+	for (int i = 0; i < count; i++) {
+		instances->data.at<InstanceVertexData>(first + i) = shapes[i];
+	}
+
+	mesh.uploadRange(1, first, count);
+}
+
+CullStats ShapeMesh::cull(const ViewBounds& view, float pixelSize) {
+	LITH_PROFILE_SCOPE("cull shapes");
+
+	int count = instances->data.count();
+	boxes.resize(count);
+
+	for (int i = 0; i < count; i++) {
+		const InstanceVertexData& shape = instances->data.at<InstanceVertexData>(i);
+
+		// the box before rotation, relative to pos, like the vertex shader
+		vec2 boxMin = min(vec2(0.f), shape.scale);
+		vec2 boxMax = max(vec2(0.f), shape.scale);
+
+		if (shape.kind == ShapeTriangle) {
+			boxMin = min(vec2(0.f), min(vec2(shape.params.x, shape.params.y), vec2(shape.params.z, shape.params.w)));
+			boxMax = max(vec2(0.f), max(vec2(shape.params.x, shape.params.y), vec2(shape.params.z, shape.params.w)));
+		}
+
+		boxMin -= vec2(pixelSize);
+		boxMax += vec2(pixelSize);
+
+		vec2 pos = vec2(shape.pos);
+
+		if (shape.rotation == 0.f) {
+			boxes.set(i, pos + boxMin, pos + boxMax);
+		}
+
+		else {
+			float radius = length(max(abs(boxMin), abs(boxMax)));
+			boxes.set(i, pos - vec2(radius), pos + vec2(radius));
+		}
+	}
+
+	int visibleCount = boxes.cull(view);
+	keepVisible(instances->data, boxes.visible.data(), visibleCount);
+
+	return { count, visibleCount };
+}
+
+ShapeMesh::InstanceVertexData makeShape(ShapeKind kind, vec2 xy, vec2 wh, float rotation, vec4 params, vec4 fill, vec4 stroke, float strokeThickness) {
+	ShapeMesh::InstanceVertexData instance;
+	instance.pos = vec3(xy, 0.f);
+	instance.scale = wh;
+	instance.rotation = rotation;
+	instance.params = params;
+	instance.strokeColor = packColor(stroke);
+	instance.fillColor = packColor(fill);
+	instance.strokeThickness = packHalf(strokeThickness);
+	instance.kind = (uint8_t)kind;
+
+	return instance;
+}
+
+void ShapeProgram::create() {
+	const char* vertexShaderSource = R"(
+		#version 330 core
+
+		layout (location = 0) in vec2 pos;
+		layout (location = 1) in vec3 instancePos;
+		layout (location = 2) in vec2 instanceScale;
+		layout (location = 3) in float instanceRotation;
+		layout (location = 4) in float instanceEdgeThickness;
+		layout (location = 5) in float instanceKind;
+		layout (location = 6) in vec4 instanceParams;
+		layout (location = 7) in vec4 instanceStroke;
+		layout (location = 8) in vec4 instanceFill;
+
+		uniform mat4 view;
+		uniform mat4 proj;
+		uniform float pixelSize;
+
+		const int KindTriangle = 3;
+
+		out vec2 fragLocal;
+		flat out int fragKind;
+		flat out vec2 fragScale;
+		flat out vec4 fragParams;
+		flat out float fragThickness;
+		flat out vec4 fragStroke;
+		flat out vec4 fragFill;
+
+		void main() {
+			int kind = int(instanceKind + 0.5);
+
+			// the box of the shape before rotation, relative to instancePos
+			vec2 boxMin = vec2(0.0);
+			vec2 boxMax = instanceScale;
+
+			if (kind == KindTriangle) {
+				boxMin = min(vec2(0.0), min(instanceParams.xy, instanceParams.zw));
+				boxMax = max(vec2(0.0), max(instanceParams.xy, instanceParams.zw));
+			}
+
+			vec2 local = mix(boxMin, boxMax, pos) + (pos * 2.0 - 1.0) * sign(boxMax - boxMin) * pixelSize;
+
+			float sr = sin(instanceRotation);
+			float cr = cos(instanceRotation);
+			vec2 world = instancePos.xy + vec2(local.x * cr - local.y * sr, local.x * sr + local.y * cr);
+
+			gl_Position = proj * view * vec4(world, instancePos.z, 1.0);
+			fragLocal = local;
+			fragKind = kind;
+			fragScale = instanceScale;
+			fragParams = instanceParams;
+			fragThickness = instanceEdgeThickness;
+			fragStroke = instanceStroke;
+			fragFill = instanceFill;
+		}
+	)";
+
+	// Signed distance functions from Inigo Quilez, negative inside
+	const char* fragmentShaderSource = R"(
+		#version 330 core
+
+		in vec2 fragLocal;
+		flat in int fragKind;
+		flat in vec2 fragScale;
+		flat in vec4 fragParams;
+		flat in float fragThickness;
+		flat in vec4 fragStroke;
+		flat in vec4 fragFill;
+
+		out vec4 outColor;
+
+		const int KindRect = 0;
+		const int KindEllipse = 1;
+		const int KindArc = 2;
+		const int KindTriangle = 3;
+
+		const float TAU = 6.28318530718;
+
+		float roundBoxDistance(vec2 p, vec2 b, float r) {
+			r = clamp(r, 0.0, min(b.x, b.y));
+			vec2 q = abs(p) - b + r;
+			return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - r;
+		}
+
+		// exact for circles, close to the edge for ellipses
+		float ellipseDistance(vec2 p, vec2 r) {
+			if (r.x == r.y) {
+				return length(p) - r.x;
+			}
+
+			float k0 = length(p / r);
+			float k1 = length(p / (r * r));
+			return k1 > 0.0 ? k0 * (k0 - 1.0) / k1 : -min(r.x, r.y);
+		}
+
+		// the wedge between two angles, in the space where the ellipse is a unit circle
+		float wedgeDistance(vec2 q, float start, float stop) {
+			float aperture = (stop - start) * 0.5;
+			float middle = start + aperture;
+
+			// turn the middle of the wedge onto +y, where it's symmetric
+			float s = sin(1.5707963 - middle);
+			float c = cos(1.5707963 - middle);
+			q = vec2(q.x * c - q.y * s, q.x * s + q.y * c);
+			q.x = abs(q.x);
+
+			vec2 edge = vec2(sin(aperture), cos(aperture));
+			float m = length(q - edge * max(dot(q, edge), 0.0));
+			return m * sign(edge.y * q.x - edge.x * q.y);
+		}
+
+		float triangleDistance(vec2 p, vec2 p0, vec2 p1, vec2 p2) {
+			vec2 e0 = p1 - p0, e1 = p2 - p1, e2 = p0 - p2;
+			vec2 v0 = p - p0, v1 = p - p1, v2 = p - p2;
+			vec2 pq0 = v0 - e0 * clamp(dot(v0, e0) / dot(e0, e0), 0.0, 1.0);
+			vec2 pq1 = v1 - e1 * clamp(dot(v1, e1) / dot(e1, e1), 0.0, 1.0);
+			vec2 pq2 = v2 - e2 * clamp(dot(v2, e2) / dot(e2, e2), 0.0, 1.0);
+			float s = sign(e0.x * e2.y - e0.y * e2.x);
+			vec2 d = min(min(vec2(dot(pq0, pq0), s * (v0.x * e0.y - v0.y * e0.x)),
+			                 vec2(dot(pq1, pq1), s * (v1.x * e1.y - v1.y * e1.x))),
+			                 vec2(dot(pq2, pq2), s * (v2.x * e2.y - v2.y * e2.x)));
+			return -sqrt(d.x) * sign(d.y);
+		}
+
+		float shapeDistance(vec2 p) {
+			// the size can be negative, then the box goes the other way from the position
+			vec2 center = fragScale * 0.5;
+			vec2 r = abs(center);
+			p -= center;
+
+			if (fragKind == KindEllipse) {
+				return ellipseDistance(p, r);
+			}
+
+			if (fragKind == KindArc) {
+				float d = ellipseDistance(p, r);
+
+				if (fragParams.y - fragParams.x < TAU) {
+					d = max(d, wedgeDistance(p / r, fragParams.x, fragParams.y) * min(r.x, r.y));
+				}
+
+				return d;
+			}
+
+			if (fragKind == KindTriangle) {
+				return triangleDistance(p + center, vec2(0.0), fragParams.xy, fragParams.zw);
+			}
+
+			return roundBoxDistance(p, r, fragParams.x);
+		}
+
+		void main() {
+			float d = shapeDistance(fragLocal);
+			float pixel = length(fwidth(fragLocal)) * 0.7071;
+
+			float shape = clamp(0.5 - d / pixel, 0.0, 1.0);
+			float inner = clamp(0.5 - (d + fragThickness) / pixel, 0.0, 1.0);
+
+			// premultiplied, so a transparent stroke doesn't darken the edge of the fill
+			vec4 stroke = vec4(fragStroke.rgb * fragStroke.a, fragStroke.a);
+			vec4 fill = vec4(fragFill.rgb * fragFill.a, fragFill.a);
+			vec4 color = stroke * (shape - inner) + fill * inner;
+
+			if (color.a <= 0.0) {
+				discard;
+			}
+
+			outColor = vec4(color.rgb / color.a, color.a);
+		}
+	)";
+
+	program = ShaderProgramBuilder()
+		.vertex(vertexShaderSource)
+		.fragment(fragmentShaderSource)
+		.build()
+		.compile();
+}
+
+void ShapeProgram::free() {
+	program.free();
+}
+
+void ShapeProgram::use(const mat4& view, const mat4& proj, float pixelSize) {
+	program.use();
+	program.setf16("view", view);
+	program.setf16("proj", proj);
+	program.setf("pixelSize", pixelSize);
+}
+
+void ShapeRenderer::create() {
+	shader.create();
+	mesh.create();
+}
+
+void ShapeRenderer::free() {
+	shader.free();
+	mesh.free();
+}
+
+void ShapeRenderer::draw(const mat4& view, const mat4& proj, float pixelSize) {
+	lastStats = mesh.cull(getViewBounds(proj * view), pixelSize);
+
+	if (lastStats.visibleCount == 0) {
+		return;
+	}
+
+	shader.use(view, proj, pixelSize);
+	mesh.draw();
+}
+
+void ShapeRenderer::drawMesh(const ShapeMesh& mesh, const mat4& view, const mat4& proj, float pixelSize) {
+	shader.use(view, proj, pixelSize);
+	mesh.drawUploaded();
+}
+
+const CullStats& ShapeRenderer::stats() const {
+	return lastStats;
+}
+
+void ShapeRenderer::clear() {
+	mesh.clear();
+}
+
+void ShapeRenderer::addRect(vec2 xy, vec2 wh, float rotation, vec4 fill, vec4 stroke, float strokeThickness) {
+	mesh.addShape(makeShape(ShapeRect, xy, wh, rotation, vec4(0), fill, stroke, strokeThickness));
+}
+
+void ShapeRenderer::addShape(const ShapeMesh::InstanceVertexData& shape) {
+	mesh.addShape(shape);
+}
+
+void ShapeRenderer::addShapes(const ShapeMesh::InstanceVertexData* shapes, int count) {
+	mesh.addShapes(shapes, count);
+}
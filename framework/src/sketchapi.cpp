@@ -1,14 +1,55 @@
 #include "lith/sketchapi.h"
+#include "lith/tessellate.h"
+#include "lith/interpolation.h"
 #include "gl/glad.h"
 
-static SketchContext* sketch;
+#include <atomic>
+#include <cstring>
+
+// The main thread draws with the context of the sketch. Job threads inside of drawParallel
+// get a copy so they can change the style, and record into their own command list.
+static thread_local SketchContext* sketch;
+static thread_local RenderCommandList* commandList = nullptr;
+static thread_local std::vector<RenderCommandList*> outerCommandLists;
 static AppContext* app;
 
+// reused by drawParallel so the lists keep their memory between frames
+static std::vector<RenderCommandList> s_batchCommands;
+
+// the copy submitCommands transforms
+static RenderCommandList s_transformedCommands;
+
+// what beginRetained records into, and the matrix it put aside
+static RenderCommandList s_retainedCommands;
+static RetainedShape* s_retainedShape = nullptr;
+static Transform2D s_retainedMatrix;
+
 static int s_keyCodeOnceLast = 0;
 static bool s_mousePressedOnceLast = false;
 static int s_loop = true;
-static float s_loopTime = 0;
-static float s_loopTimeAcc = 0;
+static int s_framelimit = 0;
+
+static void (*s_fixedUpdate)() = nullptr;
+static float s_fixedTime = 1.f / 60.f;
+static float s_fixedTimeAcc = 0;
+
+// if a frame takes longer than this many fixed updates, drop the extra time
+// instead of falling further behind each frame
+static const int s_fixedUpdateMaxSteps = 8;
+
+// shapes with more points aren't filled, each new set of points takes tens of milliseconds
+// to tessellate, which a line streamed each frame would pay every frame
+static const int s_fillMaxPoints = 16384;
+static std::atomic<bool> s_fillSkipWarned = false;
+
+// globals registered with keep during setup
+struct KeptValue {
+	std::string name;
+	void* value;
+	size_t size;
+};
+
+static std::vector<KeptValue> s_kept;
 
 float mouseX = 0;
 float mouseY = 0;
@@ -25,13 +66,23 @@ float height = 0;
 
 float deltaTime = 0;
 float totalTime = 0;
+float fixedDeltaTime = 0;
+float fixedAlpha = 0;
+
+static void sendFrameRate() {
+	lithEvent event = {};
+	event.type = lithFrameRate;
+	event.frameRate = { s_framelimit, s_loop != 0 };
+
+	app->events->out.push(event);
+}
 
 void size(int width, int height) {
 	lithEvent event = {};
 	event.type = lithWindowResize;
 	event.windowResize = { width, height };
 
-	app->events->out.push_back(event);
+	app->events->out.push(event);
 
 	float heightf = (float)height;
 
@@ -45,7 +96,7 @@ void title(const char* title) {
 	event.type = lithWindowTitle;
 	event.windowTitle = { title };
 
-	app->events->out.push_back(event);
+	app->events->out.push(event);
 }
 
 void vsync(bool enabled) {
@@ -53,7 +104,7 @@ void vsync(bool enabled) {
 	event.type = lithWindowVSync;
 	event.windowVSync = { enabled ? 1 : 0 };
 
-	app->events->out.push_back(event);
+	app->events->out.push(event);
 }
 
 void exit() {
@@ -61,19 +112,39 @@ void exit() {
 	event.type = lithExit;
 	event.exit = { 0 };
 
-	app->events->out.push_back(event);
+	app->events->out.push(event);
 }
 
 void noLoop() {
 	s_loop = false;
+	sendFrameRate();
 }
 
 void loop() {
 	s_loop = true;
+	sendFrameRate();
 }
 
 void fps(int framelimit) {
-	s_loopTime = 1.f / framelimit;
+	s_framelimit = framelimit;
+	sendFrameRate();
+}
+
+void fixedUpdate(void (*update)(), int rate) {
+	if (rate <= 0) {
+		throw nullptr;
+	}
+
+	s_fixedUpdate = update;
+	s_fixedTime = 1.f / rate;
+	s_fixedTimeAcc = 0.f;
+
+	fixedDeltaTime = s_fixedTime;
+	fixedAlpha = 0.f;
+}
+
+lithFrameStats frameStats() {
+	return sketch->frameStats;
 }
 
 float millis() {
@@ -90,12 +161,25 @@ void background(int rgb) {
 
 void background(int r, int g, int b) {
 	sketch->background = vec4(r, g, b, 255) / 255.f;
+	app->render->background(sketch->background);
+}
+
+void persistentCanvas(bool enabled) {
+	app->render->setPersistentCanvas(enabled);
 }
 
 void strokeWeight(float weight) {
 	sketch->strokeThickness = weight;
 }
 
+void strokeCap(StrokeCap cap) {
+	sketch->strokeCap = cap;
+}
+
+void strokeJoin(StrokeJoin join) {
+	sketch->strokeJoin = join;
+}
+
 void noStroke() {
 	sketch->strokeThickness = 0.f;
 	stroke(0, 0, 0, 0);
@@ -134,6 +218,68 @@ void textAlign(TextAlign alignX, TextAlign alignY) {
 	sketch->textConfig.alignY = alignY;
 }
 
+void pushMatrix() {
+	sketch->matrixStack.push_back(sketch->matrix);
+}
+
+void popMatrix() {
+	if (sketch->matrixStack.empty()) {
+		return;
+	}
+
+	sketch->matrix = sketch->matrixStack.back();
+	sketch->matrixStack.pop_back();
+}
+
+void resetMatrix() {
+	sketch->matrix = Transform2D();
+}
+
+void translate(float x, float y) {
+	translate(vec2(x, y));
+}
+
+void translate(vec2 offset) {
+	applyMatrix(Transform2D::translation(offset));
+}
+
+void rotate(float angle) {
+	applyMatrix(Transform2D::rotation(angle));
+}
+
+void scale(float scale) {
+	applyMatrix(Transform2D::scaling(vec2(scale)));
+}
+
+void scale(float x, float y) {
+	applyMatrix(Transform2D::scaling(vec2(x, y)));
+}
+
+void applyMatrix(const Transform2D& transform) {
+	sketch->matrix = sketch->matrix * transform;
+}
+
+const Transform2D& getMatrix() {
+	return sketch->matrix;
+}
+
+void point(float x, float y) {
+	point(vec2(x, y));
+}
+
+void point(vec2 position) {
+	if (sketch->stroke.a <= 0.f || sketch->strokeThickness <= 0.f) {
+		return;
+	}
+
+	vec2 size = vec2(sketch->strokeThickness);
+	ShapeMesh::InstanceVertexData shape = makeShape(ShapeEllipse, position - size / 2.f, size, 0.f, vec4(0), sketch->stroke, sketch->stroke, 0.f);
+	transformShapes(sketch->matrix, &shape, 1);
+
+	if (commandList) commandList->shape(shape);
+	else             app->render->shape(shape);
+}
+
 void line(float x1, float y1, float x2, float y2) {
 	line(vec3(x1, y1, 0), vec3(x2, y2, 0));
 }
@@ -147,15 +293,393 @@ void line(vec2 start, vec2 end) {
 }
 
 void line(vec3 start, vec3 end) {
-	app->render->line(start, end, sketch->stroke);
+	if (sketch->stroke.a <= 0.f || sketch->strokeThickness <= 0.f) {
+		return;
+	}
+
+	const Transform2D& matrix = sketch->matrix;
+	float thickness = sketch->strokeThickness;
+
+	if (!matrix.isIdentity()) {
+		start = vec3(matrix.apply(vec2(start)), start.z);
+		end = vec3(matrix.apply(vec2(end)), end.z);
+		thickness *= matrix.scaleFactor();
+	}
+
+	if (commandList) commandList->line(start, end, sketch->stroke, thickness, sketch->strokeCap);
+	else             app->render->line(start, end, sketch->stroke, thickness, sketch->strokeCap);
+}
+
+// The shape between beginShape and endShape. A segment is emitted once the point after it is
+// known, except the first, which is held until endShape so a closed shape can join it to the last.
+// Segments are collected and handed over in batches, so long shapes don't make a call for each.
+// The points are kept as well, and filled at endShape.
+//
+// Everything is kept in the space of the vertices, and the matrix is applied to the batches as
+// they're handed over. The tessellation doesn't change with the matrix, so a shape which only
+// moves is still found in the cache.
+
+struct ShapePoint {
+	vec3 position;
+	vec4 stroke;
+};
+
+// the stroke of one contour
+struct ShapeStroke {
+	ShapePoint head[3]; // the first points
+	ShapePoint tail[4]; // the last points, tail[3] is the newest
+	int count = 0;
+};
+
+struct ShapeStream {
+	ShapeStroke outline;
+	ShapeStroke hole;
+	bool inContour = false;
+
+	// the first contour is the outline, the others are holes
+	std::vector<vec2> points;
+	std::vector<int> contourEnds;
+	float z = 0.f;
+
+	// the last points given to curveVertex
+	vec2 curve[4];
+	int curveCount = 0;
+
+	std::vector<LineMesh::InstanceVertexData> segments;
+	std::vector<PolygonMesh::VertexData> vertices;
+	std::vector<vec2> curvePoints;
+};
+
+static const size_t ShapeFlushCount = 1024;
+static thread_local ShapeStream shape;
+
+// the triangles of the filled shapes, ticked at the end of each frame
+static PolygonCache s_polygons;
+
+static void flushShape() {
+	if (shape.segments.empty()) {
+		return;
+	}
+
+	transformLineSegments(sketch->matrix, shape.segments.data(), (int)shape.segments.size());
+
+	if (commandList) commandList->lineSegments(shape.segments.data(), (int)shape.segments.size());
+	else             app->render->lineSegments(shape.segments.data(), (int)shape.segments.size());
+
+	shape.segments.clear();
+}
+
+static void shapeSegment(const ShapePoint& before, const ShapePoint& a, const ShapePoint& b, const ShapePoint& after) {
+	if (a.stroke.a <= 0.f || sketch->strokeThickness <= 0.f) {
+		return;
+	}
+
+	shape.segments.push_back(makeLineSegment(a.position, b.position, vec2(before.position), vec2(after.position), 
+		a.stroke, sketch->strokeThickness, sketch->strokeCap, sketch->strokeJoin));
+
+	if (shape.segments.size() >= ShapeFlushCount) {
+		flushShape();
+	}
+}
+
+static void strokeVertex(ShapeStroke& stroke, const ShapePoint& point) {
+	if (stroke.count < 3) {
+		stroke.head[stroke.count] = point;
+	}
+
+	stroke.tail[0] = stroke.tail[1];
+	stroke.tail[1] = stroke.tail[2];
+	stroke.tail[2] = stroke.tail[3];
+	stroke.tail[3] = point;
+	stroke.count += 1;
+
+	if (stroke.count >= 4) {
+		shapeSegment(stroke.tail[0], stroke.tail[1], stroke.tail[2], stroke.tail[3]);
+	}
+}
+
+static void strokeEnd(ShapeStroke& stroke, bool close) {
+	int count = stroke.count;
+	stroke.count = 0;
+
+	const ShapePoint* head = stroke.head;
+	const ShapePoint* tail = stroke.tail;
+
+	// the first and last segments are left, each end is capped or joined to the other
+	if (close && count >= 3) {
+		shapeSegment(tail[1], tail[2], tail[3], head[0]);
+		shapeSegment(tail[2], tail[3], head[0], head[1]);
+		shapeSegment(tail[3], head[0], head[1], head[2]);
+	}
+
+	else if (count >= 2) {
+		shapeSegment(head[0], head[0], head[1], count >= 3 ? head[2] : head[1]);
+
+		if (count >= 3) {
+			shapeSegment(tail[1], tail[2], tail[3], tail[3]);
+		}
+	}
+}
+
+static void endFillContour() {
+	int begin = shape.contourEnds.empty() ? 0 : shape.contourEnds.back();
+	int end = (int)shape.points.size();
+
+	if (end > begin) {
+		shape.contourEnds.push_back(end);
+	}
+}
+
+static void fillShape() {
+	if (sketch->fill.a <= 0.f || shape.contourEnds.empty()) {
+		return;
+	}
+
+	if ((int)shape.points.size() > s_fillMaxPoints) {
+		if (!s_fillSkipWarned.exchange(true)) {
+			print("A shape with {} points wasn't filled, more than {} aren't. Call noFill() before drawing long lines", shape.points.size(), s_fillMaxPoints);
+		}
+
+		return;
+	}
+
+	PolygonCache::Indices indices = s_polygons.get(shape.points.data(), shape.contourEnds.data(), (int)shape.contourEnds.size());
+
+	if (!indices || indices->empty()) {
+		return;
+	}
+
+	uint32_t fill = packColor(sketch->fill);
+
+	shape.vertices.clear();
+	for (vec2 point : shape.points) {
+		shape.vertices.push_back({ vec3(point, shape.z), fill });
+	}
+
+	transformPolygonVertices(sketch->matrix, shape.vertices.data(), (int)shape.vertices.size());
+
+	const PolygonMesh::VertexData* vertices = shape.vertices.data();
+	int vertexCount = (int)shape.vertices.size();
+
+	if (commandList) commandList->polygon(vertices, vertexCount, indices->data(), (int)indices->size());
+	else             app->render->polygon(vertices, vertexCount, indices->data(), (int)indices->size());
+}
+
+void beginShape() {
+	shape.outline.count = 0;
+	shape.hole.count = 0;
+	shape.inContour = false;
+
+	shape.points.clear();
+	shape.contourEnds.clear();
+
+	shape.curveCount = 0;
+}
+
+void beginContour() {
+	endFillContour();
+	shape.inContour = true;
+
+	// a hole's curve starts from its own control points
+	shape.curveCount = 0;
+}
+
+void endContour() {
+	endFillContour();
+	strokeEnd(shape.hole, true);
+	shape.inContour = false;
+}
+
+void vertex(float x, float y) {
+	vertex(vec3(x, y, 0));
+}
+
+void vertex(float x, float y, float z) {
+	vertex(vec3(x, y, z));
+}
+
+void vertex(vec2 position) {
+	vertex(vec3(position, 0.f));
+}
+
+void vertex(vec3 position) {
+	ShapeStroke& stroke = shape.inContour ? shape.hole : shape.outline;
+
+	// a repeated point has no direction to join with
+	if (stroke.count > 0 && vec2(stroke.tail[3].position) == vec2(position)) {
+		return;
+	}
+
+	if (shape.points.empty()) {
+		shape.z = position.z;
+	}
+
+	shape.points.push_back(vec2(position));
+	strokeVertex(stroke, { position, sketch->stroke });
+}
+
+// How far the curves can be from their segments, a quarter of a pixel
+static float curveTolerance() {
+	const CameraLens& lens = app->render->getCamera();
+	auto [viewportWidth, viewportHeight] = app->render->getViewportSize();
+
+	if (viewportHeight <= 0) {
+		return .25f;
+	}
+
+	// perspective cameras are measured at z = 0, where 2D shapes are
+	float pixelSize = lens.ortho
+		? lens.height / viewportHeight
+		: 2.f * tan(lens.fovy / 2.f) * abs(lens.position.z) / viewportHeight;
+
+	// the curves are flattened before the matrix, which can stretch them
+	const Transform2D& matrix = sketch->matrix;
+	float stretch = max(length(matrix.axisX), length(matrix.axisY));
+
+	return max(pixelSize / max(stretch, 1e-4f), 1e-4f) * .25f;
+}
+
+static void curveVertices() {
+	for (vec2 point : shape.curvePoints) {
+		vertex(point);
+	}
+
+	shape.curvePoints.clear();
+}
+
+void bezierVertex(float cx1, float cy1, float cx2, float cy2, float x, float y) {
+	bezierVertex(vec2(cx1, cy1), vec2(cx2, cy2), vec2(x, y));
+}
+
+void bezierVertex(vec2 control1, vec2 control2, vec2 end) {
+	const ShapeStroke& stroke = shape.inContour ? shape.hole : shape.outline;
+
+	if (stroke.count == 0) {
+		vertex(control1);
+	}
+
+	vec2 start = vec2(stroke.tail[3].position);
+
+	flattenBezier(start, control1, control2, end, curveTolerance(), shape.curvePoints);
+	curveVertices();
+}
+
+void curveVertex(float x, float y) {
+	curveVertex(vec2(x, y));
+}
+
+void curveVertex(vec2 position) {
+	vec2* curve = shape.curve;
+
+	if (shape.curveCount < 4) {
+		curve[shape.curveCount] = position;
+		shape.curveCount += 1;
+	}
+
+	else {
+		curve[0] = curve[1];
+		curve[1] = curve[2];
+		curve[2] = curve[3];
+		curve[3] = position;
+	}
+
+	if (shape.curveCount < 4) {
+		return;
+	}
+
+	// the spline starts at the second point
+	if (shape.curvePoints.empty() && (shape.inContour ? shape.hole : shape.outline).count == 0) {
+		vertex(curve[1]);
+	}
+
+	flattenCatmullRom(curve[0], curve[1], curve[2], curve[3], curveTolerance(), shape.curvePoints);
+	curveVertices();
+}
+
+void bezier(float x1, float y1, float cx1, float cy1, float cx2, float cy2, float x2, float y2) {
+	bezier(vec2(x1, y1), vec2(cx1, cy1), vec2(cx2, cy2), vec2(x2, y2));
+}
+
+void bezier(vec2 start, vec2 control1, vec2 control2, vec2 end) {
+	beginShape();
+	vertex(start);
+	bezierVertex(control1, control2, end);
+	endShape();
+}
+
+void curve(float ax, float ay, float bx, float by, float cx, float cy, float dx, float dy) {
+	curve(vec2(ax, ay), vec2(bx, by), vec2(cx, cy), vec2(dx, dy));
+}
+
+void curve(vec2 a, vec2 b, vec2 c, vec2 d) {
+	beginShape();
+	curveVertex(a);
+	curveVertex(b);
+	curveVertex(c);
+	curveVertex(d);
+	endShape();
+}
+
+void endShape(bool close) {
+	if (shape.inContour) {
+		endContour();
+	}
+
+	endFillContour();
+	fillShape();
+
+	strokeEnd(shape.outline, close);
+	flushShape();
+}
+
+static void drawShape(ShapeKind kind, vec2 position, vec2 size, vec4 params) {
+	ShapeMesh::InstanceVertexData shape = makeShape(kind, position, size, 0.f, params, sketch->fill, sketch->stroke, sketch->strokeThickness);
+	transformShapes(sketch->matrix, &shape, 1);
+
+	if (commandList) commandList->shape(shape);
+	else             app->render->shape(shape);
 }
 
 void rect(float x, float y, float width, float height) {
 	rect(vec2(x, y), vec2(width, height));
 }
 
-void rect(vec2 base, vec2 size) {
-	app->render->rect(base, size, 0.f, sketch->fill, sketch->stroke, sketch->strokeThickness);
+void rect(float x, float y, float width, float height, float radius) {
+	rect(vec2(x, y), vec2(width, height), radius);
+}
+
+void rect(vec2 base, vec2 size, float radius) {
+	drawShape(ShapeRect, base, size, vec4(radius, 0, 0, 0));
+}
+
+void ellipse(float x, float y, float width, float height) {
+	ellipse(vec2(x, y), vec2(width, height));
+}
+
+void ellipse(vec2 center, vec2 size) {
+	drawShape(ShapeEllipse, center - size / 2.f, size, vec4(0));
+}
+
+void circle(float x, float y, float diameter) {
+	ellipse(vec2(x, y), vec2(diameter));
+}
+
+void arc(float x, float y, float width, float height, float start, float stop) {
+	// like processing, nothing is drawn when the angles go backwards
+	if (stop < start) {
+		return;
+	}
+
+	vec2 size = vec2(width, height);
+	drawShape(ShapeArc, vec2(x, y) - size / 2.f, size, vec4(start, stop, 0, 0));
+}
+
+void triangle(float x1, float y1, float x2, float y2, float x3, float y3) {
+	triangle(vec2(x1, y1), vec2(x2, y2), vec2(x3, y3));
+}
+
+void triangle(vec2 a, vec2 b, vec2 c) {
+	drawShape(ShapeTriangle, a, vec2(0), vec4(b - a, c - a));
 }
 
 void sprite(const TextureInterface& texture, float x, float y, float width, float height) {
@@ -163,7 +687,160 @@ void sprite(const TextureInterface& texture, float x, float y, float width, floa
 }
  
 void text(const std::string& text, float x, float y) {
-	app->render->text(vec2(x, y), sketch->textSize, sketch->textConfig, *sketch->font, text);
+	// text can only be moved and sized
+	vec2 position = sketch->matrix.apply(vec2(x, y));
+	float size = sketch->textSize * sketch->matrix.scaleFactor();
+
+	if (commandList) commandList->text(position, size, sketch->textConfig, *sketch->font, text);
+	else             app->render->text(position, size, sketch->textConfig, *sketch->font, text);
+}
+
+void sphereDetail(int resolution) {
+	sketch->sphereMesh = lithMeshIcosphere(resolution);
+}
+
+void box(float x, float y, float z, float size) {
+	box(vec3(x, y, z), vec3(size));
+}
+
+void box(vec3 position, vec3 size, quat rotation) {
+	mesh(*sketch->boxMesh, position, size, rotation);
+}
+
+void sphere(float x, float y, float z, float radius) {
+	sphere(vec3(x, y, z), radius);
+}
+
+void sphere(vec3 position, float radius) {
+	mesh(*sketch->sphereMesh, position, vec3(radius), quat(1, 0, 0, 0));
+}
+
+void mesh(const CachedMesh& mesh, vec3 position, vec3 scale, quat rotation) {
+	if (sketch->fill.a <= 0.f) {
+		return;
+	}
+
+	MeshInstance instance = makeMeshInstance(position, scale, rotation, sketch->fill);
+	transformMeshInstances(sketch->matrix, &instance, 1);
+
+	if (commandList) commandList->mesh(mesh, instance);
+	else             app->render->mesh(mesh, instance);
+}
+
+void appendPoints(PointCloud& cloud, const PointVertex* points, int count) {
+	cloud.append(points, count, app->jobs);
+}
+
+void points(const PointCloud& cloud) {
+	if (commandList) commandList->pointCloud(cloud, sketch->matrix);
+	else             app->render->pointCloud(cloud, sketch->matrix);
+}
+
+void beginCommands(RenderCommandList& list) {
+	outerCommandLists.push_back(commandList);
+	commandList = &list;
+}
+
+void endCommands() {
+	commandList = outerCommandLists.back();
+	outerCommandLists.pop_back();
+}
+
+void submitCommands(const RenderCommandList& list) {
+	if (sketch->matrix.isIdentity()) {
+		app->render->submit(list);
+		return;
+	}
+
+	s_transformedCommands.clear();
+	s_transformedCommands.append(list);
+	transformCommands(sketch->matrix, s_transformedCommands);
+
+	app->render->submit(s_transformedCommands);
+}
+
+void beginRetained(RetainedShape& shape) {
+	if (s_retainedShape) {
+		throw nullptr;
+	}
+
+	s_retainedShape = &shape;
+	s_retainedMatrix = sketch->matrix;
+	sketch->matrix = Transform2D();
+
+	s_retainedCommands.clear();
+	beginCommands(s_retainedCommands);
+}
+
+void endRetained() {
+	if (!s_retainedShape) {
+		throw nullptr;
+	}
+
+	endCommands();
+
+	RetainedShape* shape = s_retainedShape;
+	s_retainedShape = nullptr;
+	sketch->matrix = s_retainedMatrix;
+
+	shape->create(s_retainedCommands);
+}
+
+void drawRetained(const RetainedShape& shape) {
+	if (commandList) commandList->retained(shape, sketch->matrix);
+	else             app->render->retained(shape, sketch->matrix);
+}
+
+void drawParallel(int count, const std::function<void(int)>& perItem) {
+	if (count <= 0) {
+		return;
+	}
+
+	// Split into contiguous batches and submit their lists in batch order,
+	// so the result is the same as calling perItem in a loop
+
+	int batchCount = std::min(count, JOB_MAX_CONTINUATIONS);
+
+	s_batchCommands.resize(batchCount);
+	for (RenderCommandList& list : s_batchCommands) {
+		list.clear();
+	}
+
+	std::vector<int> batches(batchCount);
+	for (int i = 0; i < batchCount; i++) {
+		batches[i] = i;
+	}
+
+	const SketchContext style = *sketch;
+	JobWait wait;
+
+	JobTree& tree = app->jobs->CreateTree();
+
+	wait.After(tree.CreateEmpty()
+		.For(1, batches, [&](int batch) {
+			SketchContext local = style;
+			sketch = &local;
+			commandList = &s_batchCommands[batch];
+
+			int begin = (int)((int64_t)count * batch / batchCount);
+			int end = (int)((int64_t)count * (batch + 1) / batchCount);
+
+			for (int i = begin; i < end; i++) {
+				perItem(i);
+			}
+
+			sketch = nullptr;
+			commandList = nullptr;
+		}));
+
+	app->jobs->Run(tree);
+	wait.Wait();
+
+	LITH_PROFILE_SCOPE("submit");
+
+	for (const RenderCommandList& list : s_batchCommands) {
+		app->render->submit(list);
+	}
 }
 
 void playSound(Audio& audio) {
@@ -210,6 +887,9 @@ void __setContext(SketchContext* ctx, AppContext* app) {
 	sketch = ctx;
 	::app = app;
 
+	// setup registers them again
+	s_kept.clear();
+
 	// quick hack to remove all axes
 	*app->input = {};
 
@@ -219,15 +899,25 @@ void __setContext(SketchContext* ctx, AppContext* app) {
 	registerLoggerInterface(app->logger);
 	registerAudioBackendInterface(app->audio);
 	registerUIContext(app->ui);
+	registerProfileContext(app->profile);
+	registerMeshCacheContext(app->meshes);
 	registerFontGeneratorInterface(app->fontGenerator);
 	gladLoadGLLoader((GLADloadproc)app->window->getGraphicsAPILoaderFunction());
+
+	sketch->boxMesh = lithMeshBox();
+	sphereDetail(3);
+
+	// reset the runtime's frame pacing and canvas in case the sketch was reloaded
+	// and no longer calls fps, noLoop or persistentCanvas in setup
+	sendFrameRate();
+	app->render->setPersistentCanvas(false);
 }
 
 bool __nextFrame() {
 	// get events from runtime
 	// process these outside of loop so they don't accumulate while paused
 
-	for (const lithEvent& e : app->events->in) {
+	app->events->in.consume([](const lithEvent& e) {
 		switch (e.type) {
 			case lithKey: {
 				keyDown[e.key.keycode] = e.key.state;
@@ -250,7 +940,7 @@ bool __nextFrame() {
 				if (e.key.key == 'r' && e.key.key_alt) {
 					lithEvent event = {};
 					event.type = lithRecompilePlugin;
-					app->events->out.push_back(event);
+					app->events->out.push(event);
 				}
 
 				break;
@@ -285,9 +975,7 @@ bool __nextFrame() {
 			default:
 				break;
 		}
-	}
-	// this should go in main loop
-	app->events->in.clear();
+	});
 
 	if (s_loop) {
 		auto [viewportWidth, viewportHeight] = app->render->getViewportSize();
@@ -300,19 +988,118 @@ bool __nextFrame() {
 		deltaTime = sketch->deltaTime;
 		totalTime = sketch->totalTime;
 
-		s_loopTimeAcc += deltaTime;
+		resetMatrix();
+		sketch->matrixStack.clear();
 
-		if (s_loopTimeAcc >= s_loopTime) {
-			s_loopTimeAcc = 0.f;
+		// the runtime paces frames, so every step is a frame to draw
 
-			return true;
+		if (s_fixedUpdate) {
+			s_fixedTimeAcc += deltaTime;
+
+			int steps = 0;
+			while (s_fixedTimeAcc >= s_fixedTime && steps < s_fixedUpdateMaxSteps) {
+				fixedDeltaTime = s_fixedTime;
+
+				LITH_PROFILE_SCOPE("update");
+				s_fixedUpdate();
+
+				s_fixedTimeAcc -= s_fixedTime;
+				steps += 1;
+			}
+
+			if (steps == s_fixedUpdateMaxSteps) {
+				s_fixedTimeAcc = fmod(s_fixedTimeAcc, s_fixedTime);
+			}
+
+			fixedAlpha = s_fixedTimeAcc / s_fixedTime;
 		}
+
+		return true;
 	}
 
 	return false;
 }
 
+void __keep(const char* name, void* value, size_t size) {
+	s_kept.push_back({ name, value, size });
+}
+
+// each value is written as [name length][name][size][bytes]
+
+template<typename _t>
+static void writeState(std::vector<char>& state, const _t* data, size_t count = 1) {
+	const char* bytes = (const char*)data;
+	state.insert(state.end(), bytes, bytes + count * sizeof(_t));
+}
+
+void __saveState() {
+	sketch->state.clear();
+
+	for (const KeptValue& kept : s_kept) {
+		uint32_t nameLength = (uint32_t)kept.name.size();
+		uint64_t size = kept.size;
+
+		writeState(sketch->state, &nameLength);
+		writeState(sketch->state, kept.name.data(), nameLength);
+		writeState(sketch->state, &size);
+		writeState(sketch->state, (const char*)kept.value, kept.size);
+	}
+}
+
+// Call 'found' with each value in the state, returns false if a value runs past the end
+template<typename _f>
+static bool readState(const std::vector<char>& state, _f&& found) {
+	size_t offset = 0;
+
+	while (offset < state.size()) {
+		uint32_t nameLength;
+		uint64_t size;
+
+		if (state.size() - offset < sizeof(nameLength)) return false;
+		memcpy(&nameLength, state.data() + offset, sizeof(nameLength));
+		offset += sizeof(nameLength);
+
+		if (state.size() - offset < nameLength) return false;
+		const char* name = state.data() + offset;
+		offset += nameLength;
+
+		if (state.size() - offset < sizeof(size)) return false;
+		memcpy(&size, state.data() + offset, sizeof(size));
+		offset += sizeof(size);
+
+		if (state.size() - offset < size) return false;
+		found(name, nameLength, state.data() + offset, size);
+		offset += size;
+	}
+
+	return true;
+}
+
+void __restoreState() {
+	const std::vector<char>& state = sketch->state;
+
+	// a block which was cut short or written in another layout restores nothing,
+	// so the sketch starts fresh instead of reading past the end
+	if (!readState(state, [](const char*, uint32_t, const char*, uint64_t) {})) {
+		return;
+	}
+
+	readState(state, [](const char* name, uint32_t nameLength, const char* value, uint64_t size) {
+		for (const KeptValue& kept : s_kept) {
+			if (kept.size == size && kept.name.size() == nameLength && memcmp(kept.name.data(), name, nameLength) == 0) {
+				memcpy(kept.value, value, size);
+				break;
+			}
+		}
+	});
+
+	// not cleared, if the new version crashes cr rolls back and loads the old one again
+}
+
 void __endFrame() {
+	lithTickUI();
+	s_polygons.tick();
+
 	pmouseX = mouseX;
 	pmouseY = mouseY;
 	keyCode = 0;
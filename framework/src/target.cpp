@@ -67,6 +67,24 @@ TextureInterface* Target::get(TargetAttachmentType attachment) {
 	return a ? a->texture : nullptr;
 }
 
+int Target::getWidth() const {
+	return data.width;
+}
+
+int Target::getHeight() const {
+	return data.height;
+}
+
+void Target::blit(Target* destination, int width, int height) {
+	GLuint destinationHandle = destination ? destination->handle : 0;
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, handle);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, destinationHandle);
+	glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, destinationHandle);
+}
+
 void Target::upload() {
 	if (handle == 0) {
 		glGenFramebuffers(1, &handle);
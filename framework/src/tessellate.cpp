@@ -0,0 +1,780 @@
+#include "lith/tessellate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// The polygon is a ring of nodes linked by index, holes are spliced into it with two
+// extra nodes for each bridge. The outline is clockwise and the holes counter clockwise.
+//
+// Large polygons also link their nodes in z-order of their position, so checking an ear
+// only looks at the nodes near its bounds instead of the whole ring.
+
+namespace {
+
+// polygons with more points are hashed
+const int HashPointCount = 80;
+
+struct Node {
+	uint32_t i; // index of the point
+	float x;
+	float y;
+
+	int prev;
+	int next;
+
+	bool steiner; // a hole with one point, never filtered out
+
+	// z-order of the position, and the nodes before and after in that order, -1 at the ends
+	uint32_t z;
+	int prevZ;
+	int nextZ;
+};
+
+class Tessellator {
+public:
+	Tessellator(const vec2* points, std::vector<uint32_t>& triangles)
+		: points    (points)
+		, triangles (triangles)
+		, minX      (0.f)
+		, minY      (0.f)
+		, invSize   (0.f)
+	{}
+
+	bool run(const int* contourEnds, int contourCount) {
+		int outer = linkedList(0, contourEnds[0], true);
+
+		if (outer < 0 || nodes[outer].next == nodes[outer].prev) {
+			return false;
+		}
+
+		if (contourCount > 1) {
+			outer = eliminateHoles(contourEnds, contourCount, outer);
+		}
+
+		int pointCount = contourEnds[contourCount - 1];
+
+		if (pointCount > HashPointCount) {
+			vec2 min = points[0];
+			vec2 max = points[0];
+
+			for (int i = 1; i < pointCount; i++) {
+				min = glm::min(min, points[i]);
+				max = glm::max(max, points[i]);
+			}
+
+			float size = std::max(max.x - min.x, max.y - min.y);
+
+			minX = min.x;
+			minY = min.y;
+			invSize = size > 0.f ? 32767.f / size : 0.f;
+		}
+
+		size_t before = triangles.size();
+		earcutLinked(outer, 0);
+
+		return triangles.size() > before;
+	}
+
+private:
+	Node& n(int node) {
+		return nodes[node];
+	}
+
+	int insertNode(uint32_t i, int last) {
+		Node node;
+		node.i = i;
+		node.x = points[i].x;
+		node.y = points[i].y;
+		node.steiner = false;
+		node.z = 0;
+		node.prevZ = -1;
+		node.nextZ = -1;
+
+		int index = (int)nodes.size();
+
+		if (last < 0) {
+			node.prev = index;
+			node.next = index;
+		}
+
+		else {
+			node.next = n(last).next;
+			node.prev = last;
+			n(n(last).next).prev = index;
+			n(last).next = index;
+		}
+
+		nodes.push_back(node);
+		return index;
+	}
+
+	void removeNode(int p) {
+		n(n(p).next).prev = n(p).prev;
+		n(n(p).prev).next = n(p).next;
+
+		if (n(p).prevZ >= 0) n(n(p).prevZ).nextZ = n(p).nextZ;
+		if (n(p).nextZ >= 0) n(n(p).nextZ).prevZ = n(p).prevZ;
+	}
+
+	bool equals(int a, int b) {
+		return n(a).x == n(b).x && n(a).y == n(b).y;
+	}
+
+	// twice the signed area of the triangle, negative when it turns clockwise
+	float area(int p, int q, int r) {
+		return (n(q).y - n(p).y) * (n(r).x - n(q).x) - (n(q).x - n(p).x) * (n(r).y - n(q).y);
+	}
+
+	float signedArea(int begin, int end) {
+		float sum = 0.f;
+		for (int i = begin, j = end - 1; i < end; j = i++) {
+			sum += (points[j].x - points[i].x) * (points[i].y + points[j].y);
+		}
+
+		return sum;
+	}
+
+	int linkedList(int begin, int end, bool clockwise) {
+		int last = -1;
+
+		if (clockwise == (signedArea(begin, end) > 0)) {
+			for (int i = begin; i < end; i++) last = insertNode(i, last);
+		}
+
+		else {
+			for (int i = end - 1; i >= begin; i--) last = insertNode(i, last);
+		}
+
+		if (last >= 0 && equals(last, n(last).next)) {
+			removeNode(last);
+			last = n(last).next;
+		}
+
+		return last;
+	}
+
+	// remove duplicate and collinear points
+	int filterPoints(int start, int end = -1) {
+		if (start < 0) {
+			return start;
+		}
+
+		if (end < 0) {
+			end = start;
+		}
+
+		int p = start;
+		bool again;
+
+		do {
+			again = false;
+
+			if (!n(p).steiner && (equals(p, n(p).next) || area(n(p).prev, p, n(p).next) == 0)) {
+				removeNode(p);
+				p = end = n(p).prev;
+
+				if (p == n(p).next) {
+					break;
+				}
+
+				again = true;
+			}
+
+			else {
+				p = n(p).next;
+			}
+		} while (again || p != end);
+
+		return end;
+	}
+
+	bool pointInTriangle(float ax, float ay, float bx, float by, float cx, float cy, float px, float py) {
+		return (cx - px) * (ay - py) >= (ax - px) * (cy - py)
+			&& (ax - px) * (by - py) >= (bx - px) * (ay - py)
+			&& (bx - px) * (cy - py) >= (cx - px) * (by - py);
+	}
+
+	// p is a reflex point inside of the triangle abc, so abc can't be clipped
+	bool blocksEar(int a, int b, int c, int p) {
+		bool atCorner = equals(p, a) || equals(p, b) || equals(p, c);
+
+		return !atCorner && pointInTriangle(n(a).x, n(a).y, n(b).x, n(b).y, n(c).x, n(c).y, n(p).x, n(p).y)
+			&& area(n(p).prev, p, n(p).next) >= 0;
+	}
+
+	bool isEar(int ear) {
+		int a = n(ear).prev;
+		int b = ear;
+		int c = n(ear).next;
+
+		// reflex
+		if (area(a, b, c) >= 0) {
+			return false;
+		}
+
+		for (int p = n(c).next; p != a; p = n(p).next) {
+			if (blocksEar(a, b, c, p)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Like isEar, only checks the nodes with a z-order inside of the triangle's bounds
+	bool isEarHashed(int ear) {
+		int a = n(ear).prev;
+		int b = ear;
+		int c = n(ear).next;
+
+		if (area(a, b, c) >= 0) {
+			return false;
+		}
+
+		float x0 = std::min({ n(a).x, n(b).x, n(c).x });
+		float y0 = std::min({ n(a).y, n(b).y, n(c).y });
+		float x1 = std::max({ n(a).x, n(b).x, n(c).x });
+		float y1 = std::max({ n(a).y, n(b).y, n(c).y });
+
+		uint32_t minZ = zOrder(x0, y0);
+		uint32_t maxZ = zOrder(x1, y1);
+
+		auto blocks = [&](int p) {
+			return n(p).x >= x0 && n(p).x <= x1 && n(p).y >= y0 && n(p).y <= y1 && blocksEar(a, b, c, p);
+		};
+
+		// look both ways from the ear
+		int p = n(ear).prevZ;
+		int q = n(ear).nextZ;
+
+		while (p >= 0 && n(p).z >= minZ && q >= 0 && n(q).z <= maxZ) {
+			if (blocks(p)) return false;
+			p = n(p).prevZ;
+
+			if (blocks(q)) return false;
+			q = n(q).nextZ;
+		}
+
+		while (p >= 0 && n(p).z >= minZ) {
+			if (blocks(p)) return false;
+			p = n(p).prevZ;
+		}
+
+		while (q >= 0 && n(q).z <= maxZ) {
+			if (blocks(q)) return false;
+			q = n(q).nextZ;
+		}
+
+		return true;
+	}
+
+	// Interleave the bits of the position in 15 bits of the bounds
+	uint32_t zOrder(float x, float y) {
+		auto spread = [this](float value, float min) {
+			uint32_t v = (uint32_t)std::clamp((value - min) * invSize, 0.f, 32767.f);
+
+			v = (v | (v << 8)) & 0x00FF00FF;
+			v = (v | (v << 4)) & 0x0F0F0F0F;
+			v = (v | (v << 2)) & 0x33333333;
+			v = (v | (v << 1)) & 0x55555555;
+
+			return v;
+		};
+
+		return spread(x, minX) | (spread(y, minY) << 1);
+	}
+
+	// Link the ring in z-order, nodes added by splits since the last time get theirs first
+	void indexCurve(int start) {
+		int p = start;
+
+		do {
+			if (n(p).z == 0) {
+				n(p).z = zOrder(n(p).x, n(p).y);
+			}
+
+			n(p).prevZ = n(p).prev;
+			n(p).nextZ = n(p).next;
+			p = n(p).next;
+		} while (p != start);
+
+		n(n(p).prevZ).nextZ = -1;
+		n(p).prevZ = -1;
+
+		sortLinked(p);
+	}
+
+	// Bottom up merge sort of the z-order list, Simon Tatham's
+	void sortLinked(int list) {
+		int inSize = 1;
+		int mergeCount;
+
+		do {
+			int p = list;
+			int tail = -1;
+
+			list = -1;
+			mergeCount = 0;
+
+			while (p >= 0) {
+				mergeCount++;
+
+				int q = p;
+				int pSize = 0;
+
+				for (int i = 0; i < inSize && q >= 0; i++) {
+					pSize++;
+					q = n(q).nextZ;
+				}
+
+				int qSize = inSize;
+
+				while (pSize > 0 || (qSize > 0 && q >= 0)) {
+					int e;
+
+					if (pSize != 0 && (qSize == 0 || q < 0 || n(p).z <= n(q).z)) {
+						e = p;
+						p = n(p).nextZ;
+						pSize--;
+					}
+
+					else {
+						e = q;
+						q = n(q).nextZ;
+						qSize--;
+					}
+
+					if (tail >= 0) n(tail).nextZ = e;
+					else           list = e;
+
+					n(e).prevZ = tail;
+					tail = e;
+				}
+
+				p = q;
+			}
+
+			n(tail).nextZ = -1;
+			inSize *= 2;
+		} while (mergeCount > 1);
+	}
+
+	// Clip ears until one triangle is left. When a whole loop finds none, the points are filtered,
+	// then crossings are cut off, then the polygon is split in two by a diagonal
+	void earcutLinked(int ear, int pass) {
+		if (ear < 0) {
+			return;
+		}
+
+		bool hashed = invSize > 0.f;
+
+		if (pass == 0 && hashed) {
+			indexCurve(ear);
+		}
+
+		int stop = ear;
+
+		while (n(ear).prev != n(ear).next) {
+			int prev = n(ear).prev;
+			int next = n(ear).next;
+
+			if (hashed ? isEarHashed(ear) : isEar(ear)) {
+				triangles.push_back(n(prev).i);
+				triangles.push_back(n(ear).i);
+				triangles.push_back(n(next).i);
+
+				removeNode(ear);
+
+				ear = n(next).next;
+				stop = n(next).next;
+
+				continue;
+			}
+
+			ear = next;
+
+			if (ear == stop) {
+				if      (pass == 0) earcutLinked(filterPoints(ear), 1);
+				else if (pass == 1) earcutLinked(cureLocalIntersections(filterPoints(ear)), 2);
+				else if (pass == 2) splitEarcut(ear);
+
+				break;
+			}
+		}
+	}
+
+	int cureLocalIntersections(int start) {
+		int p = start;
+
+		do {
+			int a = n(p).prev;
+			int b = n(n(p).next).next;
+
+			if (!equals(a, b) && intersects(a, p, n(p).next, b) && locallyInside(a, b) && locallyInside(b, a)) {
+				triangles.push_back(n(a).i);
+				triangles.push_back(n(p).i);
+				triangles.push_back(n(b).i);
+
+				removeNode(p);
+				removeNode(n(p).next);
+
+				p = start = b;
+			}
+
+			p = n(p).next;
+		} while (p != start);
+
+		return filterPoints(p);
+	}
+
+	void splitEarcut(int start) {
+		int a = start;
+
+		do {
+			for (int b = n(n(a).next).next; b != n(a).prev; b = n(b).next) {
+				if (n(a).i != n(b).i && isValidDiagonal(a, b)) {
+					int c = splitPolygon(a, b);
+
+					a = filterPoints(a, n(a).next);
+					c = filterPoints(c, n(c).next);
+
+					earcutLinked(a, 0);
+					earcutLinked(c, 0);
+					return;
+				}
+			}
+
+			a = n(a).next;
+		} while (a != start);
+	}
+
+	int eliminateHoles(const int* contourEnds, int contourCount, int outer) {
+		std::vector<int> queue;
+
+		for (int contour = 1; contour < contourCount; contour++) {
+			int list = linkedList(contourEnds[contour - 1], contourEnds[contour], false);
+
+			if (list < 0) {
+				continue;
+			}
+
+			if (list == n(list).next) {
+				n(list).steiner = true;
+			}
+
+			queue.push_back(getLeftmost(list));
+		}
+
+		std::sort(queue.begin(), queue.end(), [this](int a, int b) {
+			return n(a).x < n(b).x;
+		});
+
+		for (int hole : queue) {
+			outer = eliminateHole(hole, outer);
+		}
+
+		return outer;
+	}
+
+	int eliminateHole(int hole, int outer) {
+		int bridge = findHoleBridge(hole, outer);
+
+		if (bridge < 0) {
+			return outer;
+		}
+
+		int bridgeReverse = splitPolygon(bridge, hole);
+		filterPoints(bridgeReverse, n(bridgeReverse).next);
+
+		return filterPoints(bridge, n(bridge).next);
+	}
+
+	// David Eberly's algorithm, find the outline point the hole can be joined to without crossing anything
+	int findHoleBridge(int hole, int outer) {
+		float hx = n(hole).x;
+		float hy = n(hole).y;
+		float qx = -INFINITY;
+		int m = -1;
+
+		// the nearest segment to the left of the hole's leftmost point
+		int p = outer;
+
+		do {
+			int next = n(p).next;
+
+			if (hy <= n(p).y && hy >= n(next).y && n(next).y != n(p).y) {
+				float x = n(p).x + (hy - n(p).y) * (n(next).x - n(p).x) / (n(next).y - n(p).y);
+
+				if (x <= hx && x > qx) {
+					qx = x;
+					m = n(p).x < n(next).x ? p : next;
+
+					if (x == hx) {
+						return m;
+					}
+				}
+			}
+
+			p = next;
+		} while (p != outer);
+
+		if (m < 0) {
+			return -1;
+		}
+
+		// if points are inside of the triangle of the hole, the hit and the segment's end,
+		// take the one at the smallest angle to the ray
+		int stop = m;
+		float mx = n(m).x;
+		float my = n(m).y;
+		float tanMin = INFINITY;
+
+		p = m;
+
+		do {
+			float px = n(p).x;
+			float py = n(p).y;
+
+			if (hx >= px && px >= mx && hx != px
+				&& pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, px, py))
+			{
+				float tan = std::abs(hy - py) / (hx - px);
+
+				if (locallyInside(p, hole) && (tan < tanMin || (tan == tanMin && (px > n(m).x || (px == n(m).x && sectorContainsSector(m, p)))))) {
+					m = p;
+					tanMin = tan;
+				}
+			}
+
+			p = n(p).next;
+		} while (p != stop);
+
+		return m;
+	}
+
+	bool sectorContainsSector(int m, int p) {
+		return area(n(m).prev, m, n(p).prev) < 0 && area(n(p).next, m, n(m).next) < 0;
+	}
+
+	int getLeftmost(int start) {
+		int p = start;
+		int leftmost = start;
+
+		do {
+			if (n(p).x < n(leftmost).x || (n(p).x == n(leftmost).x && n(p).y < n(leftmost).y)) {
+				leftmost = p;
+			}
+
+			p = n(p).next;
+		} while (p != start);
+
+		return leftmost;
+	}
+
+	bool isValidDiagonal(int a, int b) {
+		if (n(n(a).next).i == n(b).i || n(n(a).prev).i == n(b).i || intersectsPolygon(a, b)) {
+			return false;
+		}
+
+		bool inside = locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b)
+			&& (area(n(a).prev, a, n(b).prev) != 0 || area(a, n(b).prev, b) != 0);
+
+		bool zeroLength = equals(a, b) && area(n(a).prev, a, n(a).next) > 0 && area(n(b).prev, b, n(b).next) > 0;
+
+		return inside || zeroLength;
+	}
+
+	int sign(float value) {
+		return (value > 0) - (value < 0);
+	}
+
+	// q is on the segment pr, if they're collinear
+	bool onSegment(int p, int q, int r) {
+		return n(q).x <= std::max(n(p).x, n(r).x) && n(q).x >= std::min(n(p).x, n(r).x)
+			&& n(q).y <= std::max(n(p).y, n(r).y) && n(q).y >= std::min(n(p).y, n(r).y);
+	}
+
+	bool intersects(int p1, int q1, int p2, int q2) {
+		int o1 = sign(area(p1, q1, p2));
+		int o2 = sign(area(p1, q1, q2));
+		int o3 = sign(area(p2, q2, p1));
+		int o4 = sign(area(p2, q2, q1));
+
+		if (o1 != o2 && o3 != o4) return true;
+
+		if (o1 == 0 && onSegment(p1, p2, q1)) return true;
+		if (o2 == 0 && onSegment(p1, q2, q1)) return true;
+		if (o3 == 0 && onSegment(p2, p1, q2)) return true;
+		if (o4 == 0 && onSegment(p2, q1, q2)) return true;
+
+		return false;
+	}
+
+	bool intersectsPolygon(int a, int b) {
+		int p = a;
+
+		do {
+			int next = n(p).next;
+
+			if (n(p).i != n(a).i && n(next).i != n(a).i && n(p).i != n(b).i && n(next).i != n(b).i && intersects(p, next, a, b)) {
+				return true;
+			}
+
+			p = next;
+		} while (p != a);
+
+		return false;
+	}
+
+	bool locallyInside(int a, int b) {
+		return area(n(a).prev, a, n(a).next) < 0
+			? area(a, b, n(a).next) >= 0 && area(a, n(a).prev, b) >= 0
+			: area(a, b, n(a).prev) < 0 || area(a, n(a).next, b) < 0;
+	}
+
+	bool middleInside(int a, int b) {
+		float px = (n(a).x + n(b).x) / 2;
+		float py = (n(a).y + n(b).y) / 2;
+		bool inside = false;
+
+		int p = a;
+
+		do {
+			int next = n(p).next;
+
+			if (((n(p).y > py) != (n(next).y > py)) && n(next).y != n(p).y
+				&& (px < (n(next).x - n(p).x) * (py - n(p).y) / (n(next).y - n(p).y) + n(p).x))
+			{
+				inside = !inside;
+			}
+
+			p = next;
+		} while (p != a);
+
+		return inside;
+	}
+
+	// Join a and b with a bridge, which splits the ring in two if they're on the same one,
+	// or merges two rings. Returns the copy of b
+	int splitPolygon(int a, int b) {
+		int a2 = insertNode(n(a).i, -1);
+		int b2 = insertNode(n(b).i, -1);
+		int an = n(a).next;
+		int bp = n(b).prev;
+
+		n(a).next = b;
+		n(b).prev = a;
+
+		n(a2).next = an;
+		n(an).prev = a2;
+
+		n(b2).next = a2;
+		n(a2).prev = b2;
+
+		n(bp).next = b2;
+		n(b2).prev = bp;
+
+		return b2;
+	}
+
+private:
+	const vec2* points;
+	std::vector<uint32_t>& triangles;
+	std::vector<Node> nodes;
+
+	// bounds of the z-order, not hashed when invSize is 0
+	float minX;
+	float minY;
+	float invSize;
+};
+
+}
+
+bool tessellatePolygon(const vec2* points, const int* contourEnds, int contourCount, std::vector<uint32_t>& indices) {
+	if (contourCount <= 0 || contourEnds[0] < 3) {
+		return false;
+	}
+
+	return Tessellator(points, indices).run(contourEnds, contourCount);
+}
+
+// FNV-1a over the points and the ends
+static uint64_t hashPolygon(const vec2* points, const int* contourEnds, int contourCount) {
+	uint64_t hash = 14695981039346656037ull;
+
+	auto add = [&hash](const void* data, size_t size) {
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+	};
+
+	add(contourEnds, contourCount * sizeof(int));
+	add(points, contourEnds[contourCount - 1] * sizeof(vec2));
+
+	return hash;
+}
+
+bool PolygonCache::Entry::matches(const vec2* points, const int* contourEnds, int contourCount) const {
+	if ((int)this->contourEnds.size() != contourCount) {
+		return false;
+	}
+
+	if (memcmp(this->contourEnds.data(), contourEnds, contourCount * sizeof(int)) != 0) {
+		return false;
+	}
+
+	return memcmp(this->points.data(), points, this->points.size() * sizeof(vec2)) == 0;
+}
+
+PolygonCache::Indices PolygonCache::get(const vec2* points, const int* contourEnds, int contourCount) {
+	if (contourCount <= 0) {
+		return nullptr;
+	}
+
+	uint64_t hash = hashPolygon(points, contourEnds, contourCount);
+
+	{
+		std::scoped_lock lock(mutex);
+
+		auto itr = entries.find(hash);
+		if (itr != entries.end() && itr->second.matches(points, contourEnds, contourCount)) {
+			itr->second.used = true;
+			return itr->second.indices;
+		}
+	}
+
+	// tessellated outside of the lock, if two threads miss the same polygon both do the work
+	auto indices = std::make_shared<std::vector<uint32_t>>();
+	tessellatePolygon(points, contourEnds, contourCount, *indices);
+
+	int pointCount = contourEnds[contourCount - 1];
+
+	// a polygon with the same hash is replaced
+	std::scoped_lock lock(mutex);
+	entries[hash] = { indices, std::vector<vec2>(points, points + pointCount), std::vector<int>(contourEnds, contourEnds + contourCount), true };
+
+	return indices;
+}
+
+void PolygonCache::tick() {
+	std::scoped_lock lock(mutex);
+
+	for (auto itr = entries.begin(); itr != entries.end();) {
+		if (!itr->second.used) {
+			itr = entries.erase(itr);
+		}
+
+		else {
+			itr->second.used = false;
+			itr++;
+		}
+	}
+}
+
+int PolygonCache::size() {
+	std::scoped_lock lock(mutex);
+	return (int)entries.size();
+}
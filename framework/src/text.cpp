@@ -26,6 +26,9 @@ void TextMesh::draw() {
 
 void TextMesh::clear() {
 	mesh.clearInstances();
+
+	posMin = vec2(FLT_MAX);
+	posMax = vec2(-FLT_MAX);
 }
 
 void TextMesh::addGlyph(const TextMeshGlyph& glyph) {
@@ -49,12 +52,23 @@ void TextMesh::addGlyph(const TextMeshGlyph& glyph) {
 		v1, v3, lith,
 		v1, v4, v3
 	});
+
+	posMin = min(posMin, min(glyph.posMin, glyph.posMax));
+	posMax = max(posMax, max(glyph.posMin, glyph.posMax));
 }
 
 void TextMesh::setPixelPerfect(bool pixelPerfect) {
 	this->isPixelPerfect = pixelPerfect;
 }
 
+vec2 TextMesh::getMin() const {
+	return posMin;
+}
+
+vec2 TextMesh::getMax() const {
+	return posMax;
+}
+
 void TextProgram::create() {
 	const char* vertexShaderSource = R"(
 		#version 330 core
@@ -151,6 +165,30 @@ void TextRenderer::free() {
 }
 
 void TextRenderer::draw(const mat4& view, const mat4& proj) {
+	int count = (int)instances.size();
+	boxes.resize(count);
+
+	for (int i = 0; i < count; i++) {
+		const TextMeshInstance& inst = instances[i];
+
+		// an empty box stays empty, so strings without glyphs are never visible
+		if (inst.mesh.getMin().x > inst.mesh.getMax().x) {
+			boxes.set(i, vec2(FLT_MAX), vec2(-FLT_MAX));
+			continue;
+		}
+
+		vec2 a = inst.textPosition + inst.mesh.getMin() * inst.textSize;
+		vec2 b = inst.textPosition + inst.mesh.getMax() * inst.textSize;
+
+		boxes.set(i, min(a, b), max(a, b));
+	}
+
+	lastStats = { count, boxes.cull(getViewBounds(proj * view)) };
+
+	if (lastStats.visibleCount == 0) {
+		return;
+	}
+
 	shader.use(view, proj);
 
 	glEnable(GL_BLEND);
@@ -158,7 +196,13 @@ void TextRenderer::draw(const mat4& view, const mat4& proj) {
 
 	const TextureInterface* font = nullptr;
 
-	for (TextMeshInstance& inst : instances) {
+	for (int i = 0; i < count; i++) {
+		if (!boxes.visible[i]) {
+			continue;
+		}
+
+		TextMeshInstance& inst = instances[i];
+
 		if (font != inst.font) {
 			font = inst.font;
 			font->activate(0);
@@ -170,6 +214,10 @@ void TextRenderer::draw(const mat4& view, const mat4& proj) {
 	}
 }
 
+const CullStats& TextRenderer::stats() const {
+	return lastStats;
+}
+
 void TextRenderer::clear() {
 	for (TextMeshInstance& inst : instances) {
 		inst.mesh.clear();
@@ -0,0 +1,208 @@
+#include "lith/transform.h"
+#include "lith/command.h"
+
+Transform2D Transform2D::operator*(const Transform2D& other) const {
+	Transform2D result;
+	result.axisX = applyVector(other.axisX);
+	result.axisY = applyVector(other.axisY);
+	result.origin = apply(other.origin);
+
+	return result;
+}
+
+bool Transform2D::isIdentity() const {
+	return axisX == vec2(1, 0) && axisY == vec2(0, 1) && origin == vec2(0, 0);
+}
+
+mat4 Transform2D::matrix() const {
+	mat4 result = mat4(1.f);
+	result[0] = vec4(axisX, 0.f, 0.f);
+	result[1] = vec4(axisY, 0.f, 0.f);
+	result[3] = vec4(origin, 0.f, 1.f);
+
+	return result;
+}
+
+float Transform2D::scaleFactor() const {
+	return sqrt(abs(axisX.x * axisY.y - axisX.y * axisY.x));
+}
+
+Transform2D Transform2D::translation(vec2 offset) {
+	Transform2D result;
+	result.origin = offset;
+
+	return result;
+}
+
+Transform2D Transform2D::rotation(float angle) {
+	float s = sin(angle);
+	float c = cos(angle);
+
+	Transform2D result;
+	result.axisX = vec2(c, s);
+	result.axisY = vec2(-s, c);
+
+	return result;
+}
+
+Transform2D Transform2D::scaling(vec2 scale) {
+	Transform2D result;
+	result.axisX = vec2(scale.x, 0);
+	result.axisY = vec2(0, scale.y);
+
+	return result;
+}
+
+Transform2DParts decompose(const Transform2D& transform) {
+	vec2 x = transform.axisX;
+	vec2 y = transform.axisY;
+
+	float scaleX = length(x);
+
+	if (scaleX <= 0.f) {
+		return { 0.f, vec2(0.f, length(y)) };
+	}
+
+	// the y axis after taking out the rotation, the part along x is the shear
+	float determinant = x.x * y.y - x.y * y.x;
+
+	Transform2DParts parts;
+	parts.rotation = atan2(x.y, x.x);
+	parts.scale = vec2(scaleX, determinant / scaleX);
+
+	return parts;
+}
+
+void transformLineSegments(const Transform2D& transform, LineMesh::InstanceVertexData* segments, int count) {
+	if (transform.isIdentity()) {
+		return;
+	}
+
+	const vec2 x = transform.axisX;
+	const vec2 y = transform.axisY;
+	const vec2 o = transform.origin;
+	const float scale = transform.scaleFactor();
+
+	for (int i = 0; i < count; i++) {
+		LineMesh::InstanceVertexData& segment = segments[i];
+
+		vec2 a = vec2(segment.a);
+		vec2 b = vec2(segment.b);
+
+		segment.a = vec3(x * a.x + y * a.y + o, segment.a.z);
+		segment.b = vec3(x * b.x + y * b.y + o, segment.b.z);
+		segment.before = x * segment.before.x + y * segment.before.y + o;
+		segment.after = x * segment.after.x + y * segment.after.y + o;
+		segment.weight = packHalf(unpackHalf(segment.weight) * scale);
+	}
+}
+
+void transformShapes(const Transform2D& transform, ShapeMesh::InstanceVertexData* shapes, int count) {
+	if (transform.isIdentity()) {
+		return;
+	}
+
+	const vec2 x = transform.axisX;
+	const vec2 y = transform.axisY;
+	const vec2 o = transform.origin;
+	const float scale = transform.scaleFactor();
+
+	Transform2DParts parts = decompose(transform);
+	bool mirrored = parts.scale.y < 0.f;
+
+	for (int i = 0; i < count; i++) {
+		ShapeMesh::InstanceVertexData& shape = shapes[i];
+
+		vec2 position = vec2(shape.pos);
+		shape.pos = vec3(x * position.x + y * position.y + o, shape.pos.z);
+		shape.strokeThickness = packHalf(unpackHalf(shape.strokeThickness) * scale);
+
+		// the corners are offsets from the position, so they take the whole transform
+		if (shape.kind == ShapeTriangle) {
+			vec2 b = rotate(vec2(shape.params.x, shape.params.y), shape.rotation);
+			vec2 c = rotate(vec2(shape.params.z, shape.params.w), shape.rotation);
+
+			shape.params = vec4(transform.applyVector(b), transform.applyVector(c));
+			shape.rotation = 0.f;
+			continue;
+		}
+
+		shape.rotation += parts.rotation;
+		shape.scale *= parts.scale;
+
+		if (shape.kind == ShapeRect) {
+			shape.params.x *= scale;
+		}
+
+		// the angles go the other way around
+		if (shape.kind == ShapeArc && mirrored) {
+			shape.params = vec4(-shape.params.y, -shape.params.x, shape.params.z, shape.params.w);
+		}
+	}
+}
+
+void transformPolygonVertices(const Transform2D& transform, PolygonMesh::VertexData* vertices, int count) {
+	if (transform.isIdentity()) {
+		return;
+	}
+
+	const vec2 x = transform.axisX;
+	const vec2 y = transform.axisY;
+	const vec2 o = transform.origin;
+
+	for (int i = 0; i < count; i++) {
+		vec3& p = vertices[i].pos;
+		p = vec3(x * p.x + y * p.y + o, p.z);
+	}
+}
+
+void transformMeshInstances(const Transform2D& transform, MeshInstance* instances, int count) {
+	if (transform.isIdentity()) {
+		return;
+	}
+
+	const vec2 x = transform.axisX;
+	const vec2 y = transform.axisY;
+	const vec2 o = transform.origin;
+
+	Transform2DParts parts = decompose(transform);
+	quat turn = quat(cos(parts.rotation / 2.f), 0.f, 0.f, sin(parts.rotation / 2.f));
+
+	for (int i = 0; i < count; i++) {
+		MeshInstance& instance = instances[i];
+
+		vec2 position = vec2(instance.position);
+		instance.position = vec4(x * position.x + y * position.y + o, instance.position.z, 0.f);
+		instance.scale *= vec4(parts.scale, 1.f, 0.f);
+
+		quat rotation = turn * quat(instance.rotation.w, instance.rotation.x, instance.rotation.y, instance.rotation.z);
+		instance.rotation = vec4(rotation.x, rotation.y, rotation.z, rotation.w);
+	}
+}
+
+void transformCommands(const Transform2D& transform, RenderCommandList& commands) {
+	if (transform.isIdentity()) {
+		return;
+	}
+
+	transformLineSegments(transform, commands.lines.data(), (int)commands.lines.size());
+	transformShapes(transform, commands.shapes.data(), (int)commands.shapes.size());
+	transformPolygonVertices(transform, commands.polygonVertices.data(), (int)commands.polygonVertices.size());
+
+	for (RenderCommandList::TextCommand& text : commands.texts) {
+		text.position = transform.apply(text.position);
+		text.size *= transform.scaleFactor();
+	}
+
+	for (RenderCommandList::MeshCommand& mesh : commands.meshes) {
+		transformMeshInstances(transform, &mesh.instance, 1);
+	}
+
+	for (RenderCommandList::PointCloudCommand& cloud : commands.pointClouds) {
+		cloud.transform = transform * cloud.transform;
+	}
+
+	for (RenderCommandList::RetainedCommand& retained : commands.retainedShapes) {
+		retained.transform = transform * retained.transform;
+	}
+}
@@ -2,6 +2,7 @@
 #include "lith/sketchapi.h"
 
 #include <cstdio>
+#include <cstring>
 
 static UIContext* ctx;
 
@@ -10,25 +11,56 @@ void registerUIContext(UIContext* context) {
 }
 
 void lithTickUI() {
-	auto itr = ctx->sliders.begin();
-	while (itr != ctx->sliders.end()) {
-		if (itr->second.lastFrameUsed != ctx->frame) {
-			itr = ctx->sliders.erase(itr);
-		}
-		else {
-			++itr;
-		}
-	}
-	
+	submitCommands(ctx->commands);
+	ctx->commands.clear();
+
 	ctx->frame += 1;
 }
 
+// FNV-1a, seeded with the top of the id stack
+static UIID hashID(const void* data, size_t size) {
+	UIID hash = ctx->idStack.size() > 0 ? ctx->idStack.back() : 14695981039346656037ull;
+
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+
+	// 0 marks empty slots in the table
+	return hash != 0 ? hash : 1;
+}
+
+UIID uiID(const char* name) {
+	return hashID(name, strlen(name));
+}
+
+UIID uiID(const void* pointer) {
+	return hashID(&pointer, sizeof(pointer));
+}
+
+void pushID(const char* name) {
+	ctx->idStack.push_back(uiID(name));
+}
+
+void pushID(const void* pointer) {
+	ctx->idStack.push_back(uiID(pointer));
+}
+
+void pushID(int index) {
+	ctx->idStack.push_back(hashID(&index, sizeof(index)));
+}
+
+void popID() {
+	ctx->idStack.pop_back();
+}
+
 bool isRectHovered(float x, float y, float width, float height) {
 	return mouseX >= x && mouseX <= x + width && mouseY >= y && mouseY <= y + height;
 }
 
-bool slider(float* value, float min, float max, float x, float y, float length) {
-	SliderData& data = ctx->sliders[value];
+static SliderData& getSlider(UIID id, float min, float max, float x, float y, float length) {
+	SliderData& data = ctx->sliders.get(id, ctx->frame);
 	data.x = x;
 	data.y = y;
 	data.length = length;
@@ -36,7 +68,43 @@ bool slider(float* value, float min, float max, float x, float y, float length)
 	data.maxValue = max;
 	data.lastFrameUsed = ctx->frame;
 
-	return sliderBehavior(value, &data);
+	return data;
+}
+
+// The widgets draw with the sketch's style, recording into the UI's list.
+// Integer sliders format their label with an int
+static bool sliderRecorded(UIID id, float* value, float min, float max, float x, float y, float length, const char* format, bool integer) {
+	SliderData& data = getSlider(id, min, max, x, y, length);
+
+	beginCommands(ctx->commands);
+
+	bool dragging = sliderBehavior(value, &data);
+
+	if (format) {
+		float labelValue = integer ? round(*value) : *value;
+
+		if (data.labelFormat != format || data.labelValue != labelValue || data.label.empty()) {
+			char buffer[64];
+			if (integer) snprintf(buffer, sizeof(buffer), format, (int)labelValue);
+			else         snprintf(buffer, sizeof(buffer), format, labelValue);
+
+			data.label = buffer;
+			data.labelFormat = format;
+			data.labelValue = labelValue;
+		}
+
+		textSize(.3f);
+		textAlign(TextAlignLeft, TextAlignCenter);
+		text(data.label, x + length + .5f, y);
+	}
+
+	endCommands();
+
+	return dragging;
+}
+
+bool slider(float* value, float min, float max, float x, float y, float length) {
+	return sliderRecorded(uiID(value), value, min, max, x, y, length, nullptr, false);
 }
 
 bool sliderBehavior(float* value, SliderData* s) {
@@ -75,34 +143,21 @@ bool sliderBehavior(float* value, SliderData* s) {
 }
 
 bool sliderWithText(const char* format, float* value, float min, float max, float x, float y, float length) {
-	bool valueChanged = slider(value, min, max, x, y, length - 1);
-
-	char buffer[64];
-	int charsWritten = snprintf(buffer, sizeof(buffer), format, *value);
-
-	textSize(.3f);
-	textAlign(TextAlignLeft, TextAlignCenter);
-	text(buffer, x + length - .5, y);
-
-	return valueChanged;
+	return sliderRecorded(uiID(value), value, min, max, x, y, length - 1, format, false);
 }
 
-bool sliderInt(int* value, int min, int max, float x, float y, float length) {
+// Keyed by the int, the float it's dragged through is a temporary
+static bool sliderIntRecorded(int* value, int min, int max, float x, float y, float length, const char* format) {
 	float valueF = (float)*value;
-	bool valueChanged = slider(&valueF, (float)min, (float)max, x, y, length);
+	bool valueChanged = sliderRecorded(uiID(value), &valueF, (float)min, (float)max, x, y, length, format, true);
 	*value = (int)round(valueF);
 	return valueChanged;
 }
 
-bool sliderWithTextInt(const char* format, int* value, int min, int max, float x, float y, float length) {
-	bool valueChanged = sliderInt(value, min, max, x, y, length - 1);
-
-	char buffer[64];
-	int charsWritten = snprintf(buffer, sizeof(buffer), format, *value);
-
-	textSize(.3f);
-	textAlign(TextAlignLeft, TextAlignCenter);
-	text(buffer, x + length - .5f, y);
+bool sliderInt(int* value, int min, int max, float x, float y, float length) {
+	return sliderIntRecorded(value, min, max, x, y, length, nullptr);
+}
 
-	return valueChanged;
+bool sliderWithTextInt(const char* format, int* value, int min, int max, float x, float y, float length) {
+	return sliderIntRecorded(value, min, max, x, y, length - 1, format);
 }
@@ -0,0 +1,153 @@
+#include "ProfilerOverlay.h"
+#include "fmt/core.h"
+
+#include <algorithm>
+#include <cstring>
+
+// frames which take this long fill the chart
+static const float s_chartTime = 1.f / 30.f;
+
+static const vec4 s_palette[] = {
+	vec4(0.89f, 0.35f, 0.31f, 1.f),
+	vec4(0.96f, 0.64f, 0.26f, 1.f),
+	vec4(0.96f, 0.86f, 0.36f, 1.f),
+	vec4(0.49f, 0.80f, 0.40f, 1.f),
+	vec4(0.33f, 0.71f, 0.84f, 1.f),
+	vec4(0.45f, 0.49f, 0.89f, 1.f),
+	vec4(0.73f, 0.45f, 0.86f, 1.f),
+	vec4(0.86f, 0.45f, 0.66f, 1.f),
+};
+
+static vec4 nameColor(int name) {
+	const char* str = lithProfileGetName(name);
+
+	// don't count time spent waiting for the next frame
+	if (strcmp(str, "wait") == 0) {
+		return vec4(0.3f, 0.3f, 0.3f, 1.f);
+	}
+
+	return s_palette[name % (sizeof(s_palette) / sizeof(vec4))];
+}
+
+ProfilerOverlay::ProfilerOverlay()
+	: m_visible    (false)
+	, m_reloadTime (0.f)
+	, m_buildTime  (0.f)
+{}
+
+void ProfilerOverlay::toggle() {
+	m_visible = !m_visible;
+}
+
+bool ProfilerOverlay::isVisible() const {
+	return m_visible;
+}
+
+void ProfilerOverlay::setReloadTime(float editToFrame, float build) {
+	m_reloadTime = editToFrame;
+	m_buildTime = build;
+}
+
+void ProfilerOverlay::draw(RenderBackendInterface* render, const Font& font) {
+	if (!m_visible) {
+		return;
+	}
+
+	const CameraLens& c = render->getCamera();
+	float pt = c.height / render->getViewportSize().second;
+
+	vec2 topRight = vec2(c.position) + c.ScreenSize() / 2.f;
+
+	float padding = 8 * pt;
+	float barWidth = 3 * pt;
+	float chartWidth = barWidth * ProfileFrameCount;
+	float chartHeight = 100 * pt;
+	float scale = chartHeight / (s_chartTime * 1e9f);
+
+	vec2 chartMin = topRight - vec2(chartWidth + padding, chartHeight + padding);
+
+	render->rect(chartMin - padding / 2, vec2(chartWidth, chartHeight) + padding, 0.f, vec4(0, 0, 0, .6f), vec4(0), 0.f);
+
+	for (int i = 0; i < ProfileFrameCount; i++) {
+		const ProfileFrame* frame = lithProfileGetFrame(i);
+
+		if (!frame) {
+			break;
+		}
+
+		float x = chartMin.x + chartWidth - (i + 1) * barWidth;
+		float y = chartMin.y;
+
+		float total = min((frame->end - frame->begin) * scale, chartHeight);
+		render->rect(vec2(x, y), vec2(barWidth, total), 0.f, vec4(.5f, .5f, .5f, .5f), vec4(0), 0.f);
+
+		for (const ProfileFrameEvent& event : frame->events) {
+			if (event.thread != frame->thread || event.depth != 0) {
+				continue;
+			}
+
+			float h = min((event.end - event.begin) * scale, chartMin.y + chartHeight - y);
+			render->rect(vec2(x, y), vec2(barWidth, h), 0.f, nameColor(event.name), vec4(0), 0.f);
+
+			y += h;
+		}
+	}
+
+	// 60 fps
+	float target = chartMin.y + (1.f / 60.f) * 1e9f * scale;
+	render->line(vec3(chartMin.x, target, 0.f), vec3(chartMin.x + chartWidth, target, 0.f), vec4(1, 1, 1, .5f), 1.f, StrokeCapSquare);
+
+	// times of the last frame, summed by name
+
+	const ProfileFrame* last = lithProfileGetFrame(0);
+
+	if (!last) {
+		return;
+	}
+
+	struct ScopeTime {
+		int name;
+		int thread;
+		int depth;
+		int64_t time;
+	};
+
+	std::vector<ScopeTime> times;
+
+	for (const ProfileFrameEvent& event : last->events) {
+		bool isMain = event.thread == last->thread;
+		bool isGPU = event.thread == ProfileGPUThread;
+
+		if (!(isMain || isGPU) || event.depth > 1) {
+			continue;
+		}
+
+		auto itr = std::find_if(times.begin(), times.end(), [&](const ScopeTime& t) {
+			return t.name == event.name && t.thread == event.thread && t.depth == event.depth;
+		});
+
+		if (itr == times.end()) {
+			times.push_back({ event.name, event.thread, event.depth, 0 });
+			itr = times.end() - 1;
+		}
+
+		itr->time += event.end - event.begin;
+	}
+
+	m_text = fmt::format("frame {:.2f} ms\n", (last->end - last->begin) / 1e6f);
+
+	if (m_reloadTime > 0.f) {
+		m_text += fmt::format("reload {:.0f} ms (build {:.0f} ms)\n", m_reloadTime * 1000.f, m_buildTime * 1000.f);
+	}
+
+	for (const ScopeTime& t : times) {
+		m_text += fmt::format("{}{}{} {:.2f} ms\n",
+			t.thread == ProfileGPUThread ? "gpu " : "",
+			std::string(t.depth * 2, ' '),
+			lithProfileGetName(t.name),
+			t.time / 1e6f);
+	}
+
+	vec2 textPosition = vec2(chartMin.x - padding / 2, chartMin.y - padding);
+	render->text(textPosition, 12 * pt, { TextAlignLeft, TextAlignTop }, font, m_text);
+}
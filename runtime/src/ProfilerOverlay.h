@@ -0,0 +1,26 @@
+#pragma once
+
+#include "lith/render.h"
+#include "lith/profile.h"
+
+// Draws a bar per frame for the last ProfileFrameCount frames, stacked by
+// the top level scopes of the main thread, and the scope times of the last frame.
+class ProfilerOverlay {
+public:
+	ProfilerOverlay();
+
+	void toggle();
+	bool isVisible() const;
+
+	// Show how long the last hot reload took, from the edit being saved to the first frame
+	// drawn by the new version of the sketch, and the part of that spent building
+	void setReloadTime(float editToFrame, float build);
+
+	void draw(RenderBackendInterface* render, const Font& font);
+
+private:
+	bool m_visible;
+	float m_reloadTime;
+	float m_buildTime;
+	std::string m_text;
+};
@@ -2,17 +2,22 @@
 #include <filesystem>
 #include <fstream>
 #include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <iterator>
 
 #include "fmt/core.h"
 #include "json.hpp"
 
 #include "lith/log.h"
 
-static const char* templateBuildScript = R"(project('{}', 'c', 'cpp', default_options: ['cpp_std=c++20'])
+// The sources are listed by lith from the files in src, see writeBuildScript.
+// Set "unity": true in the .lithproj to build them as a single file
+static const char* templateBuildScript = R"(project('{0}', 'c', 'cpp', default_options: ['cpp_std=c++20'])
 
 sources = [
-	'../src/sketch.cpp'
-]
+{1}]
 
 include = include_directories(['../src'])
 
@@ -21,7 +26,14 @@ deps = [
 	dependency('glm')
 ]
 
-shared_library('{}', sources, include_directories: include, dependencies: deps))";
+# the lith api is parsed once instead of by every source on every reload
+shared_library('{0}', sources, include_directories: include, dependencies: deps, cpp_pch: 'pch/sketch_pch.h'))";
+
+// meson includes this in each source before compiling it
+static const char* templatePrecompiledHeader = R"(#pragma once
+
+#include "lith/sketchapi.h"
+)";
 
 static const char* templateSketch = R"(#include "lith/sketch.h"
 
@@ -41,8 +53,75 @@ static const char* templateProjectFile = R"({{
 	"name": "{}"
 }})";
 
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
 using namespace std::filesystem;
 
+static std::vector<std::string> getSketchSources(const path& root) {
+	std::vector<std::string> sources;
+
+	std::error_code error;
+	recursive_directory_iterator itr(root / "src", error);
+
+	for (; !error && itr != recursive_directory_iterator(); itr.increment(error)) {
+		path extension = itr->path().extension();
+
+		if (extension == ".cpp" || extension == ".cc" || extension == ".c") {
+			sources.push_back("../src/" + relative(itr->path(), root / "src").generic_string());
+		}
+	}
+
+	// the directory order isn't stable, and a different order would rewrite the script
+	std::sort(sources.begin(), sources.end());
+
+	return sources;
+}
+
+// Write the meson project of the sketch in .lith, listing every source in src. This is only
+// written when it changes, as meson reconfigures the build when it sees a new script
+static void writeBuildScript(const path& root, const std::string& name) {
+	std::string sources;
+	for (const std::string& source : getSketchSources(root)) {
+		sources += fmt::format("\t'{}',\n", source);
+	}
+
+	std::string script = fmt::format(fmt::runtime(templateBuildScript), name, sources);
+	path scriptPath = root / ".lith" / "meson.build";
+
+	std::string current;
+	{
+		std::ifstream mesonBuildFile(scriptPath, std::ios::binary);
+		current.assign(std::istreambuf_iterator<char>(mesonBuildFile), std::istreambuf_iterator<char>());
+	}
+
+	if (current != script) {
+		std::ofstream mesonBuildFile(scriptPath, std::ios::binary);
+		mesonBuildFile << script;
+	}
+
+	if (!exists(root / ".lith" / "pch" / "sketch_pch.h")) {
+		create_directories(root / ".lith" / "pch");
+
+		std::ofstream pchFile(root / ".lith" / "pch" / "sketch_pch.h");
+		pchFile << templatePrecompiledHeader;
+	}
+}
+
+// ccache skips precompiled headers unless it is told they are safe to cache, meson
+// uses ccache by itself if it's installed. Child processes inherit this
+static void setBuildEnvironment() {
+	const char* sloppiness = "pch_defines,time_macros,include_file_mtime,include_file_ctime";
+
+#ifdef _WIN32
+	_putenv_s("CCACHE_SLOPPINESS", sloppiness);
+#else
+	setenv("CCACHE_SLOPPINESS", sloppiness, 1);
+#endif
+}
+
 void CreateProject(const std::string& projectFilePath) {
 	path root = absolute(projectFilePath);
 	path outerFolder = root.parent_path();
@@ -69,10 +148,6 @@ void CreateProject(const std::string& projectFilePath) {
 	create_directories(root / ".lith");
 	create_directories(root / ".lith" / "subprojects");
 	//create_directory_symlink(frameworkPath, root / ".lith" / "subprojects" / "lith");
-	{
-		std::ofstream mesonBuildFile(root / ".lith" / "meson.build");
-		mesonBuildFile << fmt::format(fmt::runtime(templateBuildScript), name, name);
-	}
 
 	// Create src folder and its contents (default sketch file)
 	create_directories(root / "src");
@@ -80,6 +155,8 @@ void CreateProject(const std::string& projectFilePath) {
 		std::ofstream sketchFile(root / "src" / "sketch.cpp");
 		sketchFile << templateSketch;
 	}
+
+	writeBuildScript(root, name);
 }
 
 void RepairProject(const std::string& projectFilePath) {
@@ -88,10 +165,7 @@ void RepairProject(const std::string& projectFilePath) {
 	
 	create_directories(root / ".lith");
 	create_directories(root / ".lith" / "subprojects");
-	{
-		std::ofstream mesonBuildFile(root / ".lith" / "meson.build");
-		mesonBuildFile << fmt::format(fmt::runtime(templateBuildScript), name, name);
-	}
+	writeBuildScript(root, name);
 
 	if (!exists(root / (name + ".lithproj")))
 	{
@@ -109,6 +183,7 @@ Project GetProject(const std::string& projectFilePath) {
 
 	path folder = absolute(path(projectFilePath).parent_path());
 	std::string name;
+	bool unity = false;
 
 	// read name form file
 	// also basically works as a way to validate that this is a .lithproj
@@ -122,10 +197,12 @@ Project GetProject(const std::string& projectFilePath) {
 
 		nlohmann::json projectFileData = nlohmann::json::parse(f);
 		name = projectFileData["name"].get<std::string>();
+		unity = projectFileData.value("unity", false);
 	}
 
 	Project project;
 	project.name = name;
+	project.unity = unity;
 	project.folder = folder.string();
 	project.outputFile = (folder / ".lith" / "build" / (name + ".dll")).string();
 
@@ -133,17 +210,72 @@ Project GetProject(const std::string& projectFilePath) {
 }
 
 void SetupProject(const Project& project) {
+	setBuildEnvironment();
+	writeBuildScript(project.folder, project.name);
+
 	current_path(path(project.folder) / ".lith");
-	system("meson setup build");
+
+	// reconfigure an existing build to apply a change to the options
+	std::string command = fmt::format("meson setup build {} -Dunity={} -Dunity_size=10000",
+		exists("build") ? "--reconfigure" : "",
+		project.unity ? "on" : "off");
+
+	system(command.c_str());
 }
 
 void SetupProjectOnce(const Project& project) {
 	if (!exists(path(project.folder) / ".lith" / "build")) {
 		SetupProject(project);
 	}
+
+	setBuildEnvironment();
+
+	// sketches load files relative to here, whether or not the project was compiled at startup
+	current_path(path(project.folder) / ".lith");
 }
 
 void CompileProject(const Project& project) {
 	current_path(path(project.folder) / ".lith");
-	system("meson compile -C build");
+	BuildProject(project, [](const char* line) { print(line); });
+}
+
+bool BuildProject(const Project& project, const std::function<void(const char*)>& output) {
+	// pick up sources which were added or removed
+	writeBuildScript(project.folder, project.name);
+
+	path build = path(project.folder) / ".lith" / "build";
+	std::string command = fmt::format("meson compile -C \"{}\" 2>&1", build.string());
+
+	FILE* pipe = popen(command.c_str(), "r");
+	if (!pipe) {
+		return false;
+	}
+
+	char line[1024];
+	while (fgets(line, sizeof(line), pipe)) {
+		// the logger adds its own newline
+		line[strcspn(line, "\r\n")] = '\0';
+		output(line);
+	}
+
+	return pclose(pipe) == 0;
+}
+
+file_time_type GetProjectSourceTime(const Project& project) {
+	file_time_type latest = file_time_type::min();
+
+	// editors can replace files while this iterates, skip anything which errors
+	std::error_code error;
+	recursive_directory_iterator itr(path(project.folder) / "src", error);
+
+	for (; !error && itr != recursive_directory_iterator(); itr.increment(error)) {
+		std::error_code timeError;
+		file_time_type time = itr->last_write_time(timeError);
+
+		if (!timeError && time > latest) {
+			latest = time;
+		}
+	}
+
+	return latest;
 }
@@ -1,12 +1,17 @@
 #pragma once
 
 #include <string>
+#include <filesystem>
+#include <functional>
 
 struct Project {
 	std::string name;
 	std::string folder;
 	std::string outputFile;
 
+	// build the sources as one file, "unity" in the .lithproj
+	bool unity = false;
+
 	bool failedToLoad = false;
 };
 
@@ -18,4 +23,12 @@ Project GetProject(const std::string& projectFilePath);
 
 void SetupProject(const Project& project);
 void SetupProjectOnce(const Project& project);
-void CompileProject(const Project& project);
\ No newline at end of file
+void CompileProject(const Project& project);
+
+// Run an incremental build of the sketch library, passing each line of the build's output
+// to 'output'. Returns true if the build succeeded. This doesn't change the working directory,
+// so it can run on a job thread
+bool BuildProject(const Project& project, const std::function<void(const char*)>& output);
+
+// The latest write time of the files in the project's src folder
+std::filesystem::file_time_type GetProjectSourceTime(const Project& project);
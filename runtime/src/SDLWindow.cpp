@@ -112,7 +112,7 @@ void SDLWindow::makeCurrent() {
 	SDL_GL_MakeCurrent(m_window, s_opengl);
 }
 
-void SDLWindow::pollEvents(EventPipe* events) {
+void SDLWindow::pollEvents(EventRing* events) {
 	auto [windowWidth, windowHeight] = getSize();
 
 	SDL_Event event;
@@ -123,7 +123,7 @@ void SDLWindow::pollEvents(EventPipe* events) {
 				e.type = lithExit;
 				e.exit.code = 0;
 
-				events->in.push_back(e);
+				events->push(e);
 				break;
 			}
 
@@ -135,7 +135,7 @@ void SDLWindow::pollEvents(EventPipe* events) {
 						e.windowResize.width = event.window.data1;
 						e.windowResize.height = event.window.data2;
 
-						events->in.push_back(e);
+						events->push(e);
 						break;
 				}
 
@@ -166,7 +166,7 @@ void SDLWindow::pollEvents(EventPipe* events) {
 				e.mouse.button_repeat = event.button.clicks;
 				e.mouse.is_wheel = false;
 
-				events->in.push_back(e);
+				events->push(e);
 				break;
 			}
 
@@ -203,7 +203,7 @@ void SDLWindow::pollEvents(EventPipe* events) {
 				e.mouse.button_repeat = event.button.clicks;
 				e.mouse.is_wheel = false;
 
-				events->in.push_back(e);
+				events->push(e);
 				break;
 			}
 
@@ -217,7 +217,7 @@ void SDLWindow::pollEvents(EventPipe* events) {
 				e.mouse.vel_y = event.wheel.preciseY * flip;
 				e.mouse.is_wheel = true;
 
-				events->in.push_back(e);
+				events->push(e);
 				break;
 			}
 
@@ -229,16 +229,18 @@ void SDLWindow::pollEvents(EventPipe* events) {
 				e.key.keycode = (KeyboardInput)event.key.keysym.scancode;
 				e.key.key = (char)event.key.keysym.sym;
 				e.key.state = (bool)event.key.state;
-				e.key.repeat = (int)event.key.repeat;
+				e.key.repeat = event.key.repeat;
 				e.key.key_shift = bool(event.key.keysym.mod & KMOD_SHIFT);
 				e.key.key_ctrl = bool(event.key.keysym.mod & KMOD_CTRL);
 				e.key.key_alt = bool(event.key.keysym.mod & KMOD_ALT);
 
-				events->in.push_back(e);
+				events->push(e);
 				break;
 			}
 		}
 	}
+
+	events->flush();
 }
 
 void SDLWindow::setTitle(const char* name) {
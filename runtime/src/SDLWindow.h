@@ -16,7 +16,7 @@ public:
 	void swapBuffers() override;
 	void makeCurrent() override;
 
-	void pollEvents(EventPipe* events) override;
+	void pollEvents(EventRing* events) override;
 
 	void setTitle(const char* name) override;
 	void setWindowSize(int width, int height) override;
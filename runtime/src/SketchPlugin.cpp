@@ -14,6 +14,7 @@ SketchPlugin::SketchPlugin()
 	: m_sketch  (nullptr)
 	, m_context (nullptr)
 	, m_plugin  (nullptr)
+	, m_reload  (false)
 {}
 
 SketchPlugin::SketchPlugin(const Project& project)
@@ -21,6 +22,7 @@ SketchPlugin::SketchPlugin(const Project& project)
 	, m_sketch  (nullptr)
 	, m_context (nullptr)
 	, m_plugin  (nullptr)
+	, m_reload  (false)
 {}
 
 void SketchPlugin::create(AppContext* app) {
@@ -65,20 +67,22 @@ void SketchPlugin::free() {
 void SketchPlugin::update() {
 	m_sketch->deltaTime = lithDeltaTime();
 	m_sketch->totalTime = lithTotalTime();
+	m_sketch->frameStats = lithGetFrameStats();
 
-	cr_plugin_update(*m_plugin);
+	cr_plugin_update(*m_plugin, m_reload);
+	m_reload = false;
+}
+
+void SketchPlugin::reload() {
+	m_reload = true;
 }
 
 void SketchPlugin::sendEventIn(const lithEvent& event) {
-	m_context->app->events->in.push_back(event);
+	m_context->app->events->in.push(event);
 }
 
 void SketchPlugin::handleEventsOut(lithEventHandler handler) {
-	for (const lithEvent& event : m_context->app->events->out) {
-		handler(event);
-	}
-
-	m_context->app->events->out.clear();
+	m_context->app->events->out.consume(handler);
 }
 
 SketchContext* SketchPlugin::getContext() {
@@ -92,3 +96,7 @@ const Project& SketchPlugin::getProject() const {
 bool SketchPlugin::isLoaded() const {
 	return !!m_sketch;
 }
+
+unsigned SketchPlugin::getVersion() const {
+	return m_plugin ? m_plugin->version : 0;
+}
@@ -22,14 +22,23 @@ public:
 	void sendEventIn(const lithEvent& event) override;
 	void handleEventsOut(lithEventHandler handler) override;
 
+	// Check for a new build of the library on the next update. This isn't done every frame,
+	// so the library isn't loaded while the linker is still writing it
+	void reload();
+
 	SketchContext* getContext();
 	const Project& getProject() const;
 	bool isLoaded() const;
 
+	// Bumped each time a new version of the library is loaded
+	unsigned getVersion() const;
+
 private:
 	Project m_project;
 
 	SketchContext* m_sketch;
 	PluginContext* m_context;
 	cr_plugin* m_plugin;
+
+	bool m_reload;
 };
\ No newline at end of file
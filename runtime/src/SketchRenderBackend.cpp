@@ -1,40 +1,177 @@
 #include "SketchRenderBackend.h"
 #include "lith/lens.h"
+#include "lith/profile.h"
 #include "gl/glad.h"
 
 void SketchRenderBackend::create() {
 	m_line.create();
-	m_rect.create();
+	m_shape.create();
+	m_polygon.create();
 	m_text.create();
+	m_mesh.create();
+	m_points.create();
 }
 
 void SketchRenderBackend::free() {
 	m_line.free();
-	m_rect.free();
+	m_shape.free();
+	m_polygon.free();
 	m_text.free();
+	m_mesh.free();
+	m_points.free();
+
+	freeCanvas();
 }
 
 void SketchRenderBackend::clear() {
-	m_line.clear();
-	m_rect.clear();
-	m_text.clear();
-
+	clearBatches();
 	m_textCache.clear();
 }
 
 void SketchRenderBackend::draw() {
+	if (!m_persistent) {
+		freeCanvas();
+
+		useScreenTarget();
+		glClearColor(m_background.r, m_background.g, m_background.b, m_background.a);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		drawBatches();
+		return;
+	}
+
+	useCanvas();
+	drawBatches();
+
+	{
+		LITH_PROFILE_GPU_SCOPE("canvas");
+		m_canvas.blit(nullptr, m_width, m_height);
+	}
+}
+
+void SketchRenderBackend::drawOverlay() {
+	useScreenTarget();
+	glClear(GL_DEPTH_BUFFER_BIT);
+
+	drawBatches();
+}
+
+void SketchRenderBackend::drawBatches() {
 	glViewport(0, 0, m_width, m_height);
 
+	mat4 view = m_lens.GetViewMatrix();
+	mat4 proj = m_lens.GetProjectionMatrix();
+
+	{
+		LITH_PROFILE_GPU_SCOPE("mesh");
+		m_mesh.draw(view, proj, m_jobs);
+	}
+
 	glDisable(GL_DEPTH_TEST);
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	mat4 view = m_lens.GetViewMatrix();
-	mat4 proj = m_lens.GetProjectionMatrix();
+	{
+		LITH_PROFILE_GPU_SCOPE("points");
+		m_points.draw(m_lens, m_height);
+	}
+
+	// lines and shapes are padded by a pixel for their anti-aliased edge, perspective
+	// cameras don't have one size so they only fade on the inside
+	float pixelSize = m_lens.ortho ? m_lens.height / m_height : 0.f;
+
+	// retained shapes have their transform in the view, so the padding is in their space
 
-	m_line.draw(view, proj);
-	m_rect.draw(view, proj, m_pixelDensity);
-	m_text.draw(view, proj);
+	{
+		LITH_PROFILE_GPU_SCOPE("polygon");
+		m_polygon.draw(view, proj);
+
+		for (const RetainedItem& item : m_retained) {
+			m_polygon.drawMesh(item.shape->polygons, view * item.transform.matrix(), proj);
+		}
+	}
+
+	{
+		LITH_PROFILE_GPU_SCOPE("line");
+		m_line.draw(view, proj, pixelSize);
+
+		for (const RetainedItem& item : m_retained) {
+			float scale = max(item.transform.scaleFactor(), 1e-6f);
+			m_line.drawMesh(item.shape->lines, view * item.transform.matrix(), proj, pixelSize / scale);
+		}
+	}
+
+	{
+		LITH_PROFILE_GPU_SCOPE("shape");
+		m_shape.draw(view, proj, pixelSize);
+
+		for (const RetainedItem& item : m_retained) {
+			float scale = max(item.transform.scaleFactor(), 1e-6f);
+			m_shape.drawMesh(item.shape->shapes, view * item.transform.matrix(), proj, pixelSize / scale);
+		}
+	}
+
+	{
+		LITH_PROFILE_GPU_SCOPE("text");
+		m_text.draw(view, proj);
+	}
+}
+
+void SketchRenderBackend::clearBatches() {
+	m_line.clear();
+	m_shape.clear();
+	m_polygon.clear();
+	m_text.clear();
+	m_mesh.clear();
+	m_points.clear();
+
+	m_retained.clear();
+}
+
+void SketchRenderBackend::useCanvas() {
+	bool resized = m_hasCanvas && (m_canvas.getWidth() != m_width || m_canvas.getHeight() != m_height);
+
+	if (!m_hasCanvas || resized) {
+		Target canvas = TargetBuilder()
+			.size(m_width, m_height)
+			.attach(TargetAttachmentColor0, TextureFormatRGBA)
+			.attach(TargetAttachmentDepth, TextureFormatDepth)
+			.build();
+
+		canvas.upload();
+		glClearColor(m_background.r, m_background.g, m_background.b, m_background.a);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// the camera is reset to the new size with the origin at the bottom left,
+		// so the old canvas lines up there
+		if (resized) {
+			m_canvas.blit(&canvas, min(m_width, m_canvas.getWidth()), min(m_height, m_canvas.getHeight()));
+			m_canvas.free();
+		}
+
+		m_canvas = canvas;
+		m_hasCanvas = true;
+	}
+
+	m_canvas.use();
+
+	// each frame draws its meshes on top of the last
+	if (m_clearCanvas) {
+		glClearColor(m_background.r, m_background.g, m_background.b, m_background.a);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		m_clearCanvas = false;
+	}
+
+	else {
+		glClear(GL_DEPTH_BUFFER_BIT);
+	}
+}
+
+void SketchRenderBackend::freeCanvas() {
+	if (m_hasCanvas) {
+		m_canvas.free();
+		m_hasCanvas = false;
+	}
 }
 
 std::pair<int, int> SketchRenderBackend::getViewportSize() const {
@@ -65,15 +202,117 @@ void SketchRenderBackend::setCamera(const CameraLens& lens) {
 	m_lens = lens;
 }
 
-void SketchRenderBackend::line(vec3 positionBegin, vec3 positionEnd, vec4 stroke) {
-	m_line.addLine(positionBegin, positionEnd, stroke, 1.f);	
+void SketchRenderBackend::background(vec4 color) {
+	m_background = color;
+	m_clearCanvas = true;
+
+	clearBatches();
+}
+
+void SketchRenderBackend::setPersistentCanvas(bool persistent) {
+	m_persistent = persistent;
+}
+
+void SketchRenderBackend::line(vec3 positionBegin, vec3 positionEnd, vec4 stroke, float strokeThickness, StrokeCap cap) {
+	m_line.addLine(positionBegin, positionEnd, stroke, strokeThickness, cap);
+}
+
+void SketchRenderBackend::lineSegments(const LineMesh::InstanceVertexData* segments, int count) {
+	m_line.addLines(segments, count);
 }
 
 void SketchRenderBackend::rect(vec2 position, vec2 size, float rotation, vec4 fill, vec4 stroke, float strokeThickness) {
-	m_rect.addRect(position, size, rotation, fill, stroke, strokeThickness);
+	m_shape.addRect(position, size, rotation, fill, stroke, strokeThickness);
+}
+
+void SketchRenderBackend::shape(const ShapeMesh::InstanceVertexData& shape) {
+	m_shape.addShape(shape);
+}
+
+void SketchRenderBackend::polygon(const PolygonMesh::VertexData* vertices, int vertexCount, const uint32_t* indices, int indexCount) {
+	m_polygon.addPolygon(vertices, vertexCount, indices, indexCount);
 }
 
 void SketchRenderBackend::text(vec2 position, float size, TextMeshGenerationConfig alignment, const Font& font, const std::string& text) {
 	TextMesh& mesh = m_textCache.getOrCreateTextMesh(text.c_str(), alignment, font);
 	m_text.addString(position, size, &font, mesh);
+}
+
+void SketchRenderBackend::mesh(const CachedMesh& mesh, const MeshInstance& instance) {
+	m_mesh.addMesh(mesh, instance);
+}
+
+void SketchRenderBackend::pointCloud(const PointCloud& cloud, const Transform2D& transform) {
+	m_points.addPointCloud(cloud, transform);
+}
+
+void SketchRenderBackend::retained(const RetainedShape& shape, const Transform2D& transform) {
+	if (!shape.isCreated()) {
+		return;
+	}
+
+	m_retained.push_back({ &shape, transform });
+
+	// text, meshes and nested retained shapes go in with the rest of the frame
+	if (shape.rest.empty()) {
+		return;
+	}
+
+	if (transform.isIdentity()) {
+		submit(shape.rest);
+		return;
+	}
+
+	// local, submit draws nested shapes through here again
+	RenderCommandList rest;
+	rest.append(shape.rest);
+	transformCommands(transform, rest);
+
+	submit(rest);
+}
+
+void SketchRenderBackend::submit(const RenderCommandList& commands) {
+	m_line.addLines(commands.lines.data(), (int)commands.lines.size());
+	m_shape.addShapes(commands.shapes.data(), (int)commands.shapes.size());
+	m_polygon.addPolygon(commands.polygonVertices.data(), (int)commands.polygonVertices.size(), commands.polygonIndices.data(), (int)commands.polygonIndices.size());
+
+	for (const RenderCommandList::TextCommand& command : commands.texts) {
+		text(command.position, command.size, command.config, *command.font, command.text);
+	}
+
+	for (const RenderCommandList::MeshCommand& command : commands.meshes) {
+		m_mesh.addMesh(*command.mesh, command.instance);
+	}
+
+	for (const RenderCommandList::PointCloudCommand& command : commands.pointClouds) {
+		m_points.addPointCloud(*command.cloud, command.transform);
+	}
+
+	for (const RenderCommandList::RetainedCommand& command : commands.retainedShapes) {
+		retained(*command.shape, command.transform);
+	}
+}
+
+void SketchRenderBackend::setJobExecutor(JobExecutor* jobs) {
+	m_jobs = jobs;
+}
+
+const MeshRenderStats& SketchRenderBackend::getMeshStats() const {
+	return m_mesh.stats();
+}
+
+const PointCloudRenderStats& SketchRenderBackend::getPointStats() const {
+	return m_points.stats();
+}
+
+const CullStats& SketchRenderBackend::getLineStats() const {
+	return m_line.stats();
+}
+
+const CullStats& SketchRenderBackend::getShapeStats() const {
+	return m_shape.stats();
+}
+
+const CullStats& SketchRenderBackend::getTextStats() const {
+	return m_text.stats();
 }
\ No newline at end of file
@@ -3,8 +3,12 @@
 #include "lith/render.h"
 
 #include "lith/line.h"
-#include "lith/rect.h"
+#include "lith/shape.h"
+#include "lith/polygon.h"
 #include "lith/text.h"
+#include "lith/meshrender.h"
+#include "lith/pointcloud.h"
+#include "lith/target.h"
 //#include "lith/sprite.h"
 
 #include "lith/font.h"
@@ -25,14 +29,48 @@ public:
 	void setPixelDensity(float density) override;
 	void setCamera(const CameraLens& lens) override;
 
-	void line(vec3 positionBegin, vec3 positionEnd, vec4 stroke) override;
+	void background(vec4 color) override;
+	void setPersistentCanvas(bool persistent) override;
+
+	void line(vec3 positionBegin, vec3 positionEnd, vec4 stroke, float strokeThickness, StrokeCap cap) override;
+	void lineSegments(const LineMesh::InstanceVertexData* segments, int count) override;
 	void rect(vec2 position, vec2 size, float rotation, vec4 fill, vec4 stroke, float strokeThickness) override;
+	void shape(const ShapeMesh::InstanceVertexData& shape) override;
+	void polygon(const PolygonMesh::VertexData* vertices, int vertexCount, const uint32_t* indices, int indexCount) override;
 	void text(vec2 position, float size, TextMeshGenerationConfig alignment, const Font& font, const std::string& text) override;
+	void mesh(const CachedMesh& mesh, const MeshInstance& instance) override;
+	void pointCloud(const PointCloud& cloud, const Transform2D& transform) override;
+	void retained(const RetainedShape& shape, const Transform2D& transform) override;
+
+	void submit(const RenderCommandList& commands) override;
+
+	// Draw straight to the screen on top of the frame, for the runtime's overlays
+	void drawOverlay();
+
+	// Drop what was added without ticking the caches, between draw and drawOverlay
+	void clearBatches();
 	
 	// put in sprite, should change it to use interface first
 
 	// allow access to simple data
 
+	// used to cull meshes in parallel, can be null
+	void setJobExecutor(JobExecutor* jobs);
+	const MeshRenderStats& getMeshStats() const;
+	const PointCloudRenderStats& getPointStats() const;
+
+	// how many of what was added was inside the view
+	const CullStats& getLineStats() const;
+	const CullStats& getShapeStats() const;
+	const CullStats& getTextStats() const;
+
+private:
+	void drawBatches();
+
+	// Make sure the canvas is the size of the viewport and draw into it
+	void useCanvas();
+	void freeCanvas();
+
 private:
 	int m_width;
 	int m_height;
@@ -41,9 +79,30 @@ private:
 	CameraLens m_lens;
 
 	LineRenderer m_line;
-	RectRenderer m_rect;
+	ShapeRenderer m_shape;
+	PolygonRenderer m_polygon;
 	TextRenderer m_text;
+	MeshRenderer m_mesh;
+	PointCloudRenderer m_points;
 	//SpriteRenderer* sprite;
 
 	FontTextMeshCache m_textCache;
+
+	struct RetainedItem {
+		const RetainedShape* shape;
+		Transform2D transform;
+	};
+
+	std::vector<RetainedItem> m_retained;
+
+	vec4 m_background = vec4(.06f, .06f, .06f, 1.f);
+
+	// the canvas is freed in draw once it's no longer persistent, so a sketch which
+	// turns it off and on again while reloading keeps what it drew
+	Target m_canvas;
+	bool m_persistent = false;
+	bool m_hasCanvas = false;
+	bool m_clearCanvas = false;
+
+	JobExecutor* m_jobs = nullptr;
 };
\ No newline at end of file
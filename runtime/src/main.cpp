@@ -6,6 +6,7 @@
 #include "lith/timer.h"
 #include "lith/job.h"
 #include "lith/ui.h"
+#include "lith/profile.h"
 
 #include "Project.h"
 
@@ -15,41 +16,123 @@
 #include "SDLMixerAudioBackend.h"
 #include "printfLogger.h"
 #include "msdfgenFontGenerator.h"
+#include "ProfilerOverlay.h"
 
 #include <cstring>
+#include <chrono>
+#include <filesystem>
 
 static SketchPlugin s_plugin;
 static AppContext s_app;
 
 static EventPipe s_events;
+static EventRing s_windowEvents; // read by the runtime, then passed on to the sketch
 static SDLMixerAudioBackend s_audio;
 static SketchRenderBackend s_render;
 static InputMap s_input;
 static SDLWindow s_window;
+static ProfileContext s_profile; // before s_job so worker threads stop profiling before this is destroyed
 static JobExecutor s_job;
+static MeshCacheContext s_meshes;
 static printfLogger s_log;
 static msdfgenFontGenerator s_fontGenerator;
 
 static UIContext s_ui;
+static ProfilerOverlay s_profilerOverlay;
 
-static std::atomic<bool> s_compiling = false;
 static bool running = true;
 
+static const float s_idleFrameLimit = 30.f;
+
+// Hot reload
+//	The sources are polled, a few stat calls every s_sourcePollInterval are cheap and work the same
+//	on every platform. When they change, an incremental build runs on a job thread. Once it succeeds,
+//	the plugin checks for the new library on its next update, which cr swaps in.
+
+using file_time = std::filesystem::file_time_type;
+
+static const float s_sourcePollInterval = .25f;
+static float s_nextSourcePoll = 0.f;
+
+static std::atomic<bool> s_compiling = false;
+static std::atomic<bool> s_compiled = false; // set by a build which succeeded
+static bool s_compileRequested = false;
+static bool s_compileTimed = false; // the requested build follows a change seen while running
+static std::atomic<float> s_buildTime = 0.f; // written by the build, read after the reload
+
+static file_time s_sourceTime = file_time::min(); // latest change seen, the first poll always builds
+
+// min when the version wasn't built for a change seen while running, like the build at startup,
+// whose sources may have been saved days ago
+static file_time s_buildSourceTime = file_time::min();  // latest change in the build which is running
+static file_time s_reloadSourceTime = file_time::min(); // latest change in the version being swapped in
+static unsigned s_pluginVersion = 0;
+
 void compileSketch(Job job) {
 	print("Building sketch...");
-	s_compiling = true;
 
-	// FILE* file = _popen(GetBuildProjectLibraryCommand(s_plugin.getProject()).c_str(), "r");
+	float begin = lithGetTime();
+	bool built = BuildProject(s_plugin.getProject(), [](const char* line) { print(line); });
+	float buildTime = lithGetTime() - begin;
+	s_buildTime = buildTime;
 
-	// char buffer[1024];
-	// while (fgets(buffer, sizeof(buffer), file) != nullptr) {
-	// 	printNoNewline(buffer);
-	// }
-
-	// _pclose(file);
+	if (built) print("Built sketch in {:.2f} s", buildTime);
+	else       print("Failed to build sketch");
 
+	s_compiled = built;
 	s_compiling = false;
-	print("Done");
+}
+
+void watchSketch() {
+	if (s_compiled.exchange(false)) {
+		s_reloadSourceTime = s_buildSourceTime;
+		s_plugin.reload();
+	}
+
+	float now = lithGetTime();
+
+	if (now >= s_nextSourcePoll) {
+		s_nextSourcePoll = now + s_sourcePollInterval;
+
+		file_time sourceTime = GetProjectSourceTime(s_plugin.getProject());
+
+		if (sourceTime > s_sourceTime) {
+			s_compileTimed = s_sourceTime != file_time::min();
+			s_sourceTime = sourceTime;
+			s_compileRequested = true;
+		}
+	}
+
+	// changes saved during a build start another once it's done
+	if (s_compileRequested && !s_compiling) {
+		s_compileRequested = false;
+		s_compiling = true;
+		s_buildSourceTime = s_compileTimed ? s_sourceTime : file_time::min();
+
+		JobTree& tree = s_job.CreateTree();
+		tree.Create(compileSketch);
+		s_job.Run(tree);
+	}
+}
+
+// Call after the frame is presented
+void timeReload() {
+	unsigned version = s_plugin.getVersion();
+
+	if (version == s_pluginVersion) {
+		return;
+	}
+
+	s_pluginVersion = version;
+
+	if (s_reloadSourceTime == file_time::min()) {
+		return;
+	}
+
+	float editToFrame = std::chrono::duration<float>(file_time::clock::now() - s_reloadSourceTime).count();
+	s_profilerOverlay.setReloadTime(editToFrame, s_buildTime.load());
+
+	print("Reloaded sketch {:.0f} ms after the edit", editToFrame * 1000.f);
 }
 
 void sketchPluginEventHandler(const lithEvent& event) {
@@ -76,14 +159,26 @@ void sketchPluginEventHandler(const lithEvent& event) {
 			break;
 		}
 
+		case lithFrameRate: {
+			float framelimit = (float)event.frameRate.framelimit;
+
+			// still need to poll events and draw the overlay while the sketch
+			// isn't looping, but there is no reason to do it faster than this
+			if (!event.frameRate.loop && (framelimit == 0 || framelimit > s_idleFrameLimit)) {
+				framelimit = s_idleFrameLimit;
+			}
+
+			lithSetFrameLimit(framelimit);
+			break;
+		}
+
 		case lithRecompilePlugin: {
 			print("Attempting to recompile");
 
-			if (!s_compiling) {
-				JobTree& tree = s_job.CreateTree();
-				tree.Create(compileSketch);
-				s_job.Run(tree);
-			}
+			// as if the sources were saved now, so the reload is timed from the request
+			s_sourceTime = file_time::clock::now();
+			s_compileRequested = true;
+			s_compileTimed = true;
 
 			break;
 		}
@@ -101,7 +196,7 @@ void sendInputEvent(InputCode code, float state) {
 		event.input.name = name;
 		event.input.state = state;
 
-		s_events.in.push_back(event);
+		s_events.in.push(event);
 	}
 }
 
@@ -109,6 +204,20 @@ void inputEventHandler(const lithEvent& event) {
 	switch (event.type) {
 		case lithKey: {
 			sendInputEvent(event.key.keycode, event.key.state ? 1.f : 0.f);
+
+			if (event.key.state && event.key.key_alt && !event.key.repeat) {
+				if (event.key.key == 'p') {
+					s_profilerOverlay.toggle();
+				}
+
+				if (event.key.key == 't') {
+					const char* filepath = "profile.json";
+
+					if (lithProfileWriteChromeTrace(filepath)) print("Wrote profile to {}", filepath);
+					else                                       print("Failed to write profile to {}", filepath);
+				}
+			}
+
 			break;
 		}
 		case lithMouse: {
@@ -164,6 +273,9 @@ int main(int argc, char *argv[]) {
 	registerLoggerInterface(&s_log);
 	registerAudioBackendInterface(&s_audio);
 	registerUIContext(&s_ui);
+	registerProfileContext(&s_profile);
+	registerMeshCacheContext(&s_meshes);
+	s_fontGenerator.setJobExecutor(&s_job);
 	registerFontGeneratorInterface(&s_fontGenerator);
 
 	if (argc >= 3 && strcmp(argv[1], "create") == 0) {
@@ -202,10 +314,14 @@ int main(int argc, char *argv[]) {
 	print("Init project");
 	SetupProjectOnce(project); // init if this is the first time running a project
 
-	print("Compile project");
-	CompileProject(project);
+	// Start on the library from the last run if there is one, the first
+	// poll of the sources builds and swaps in any changes since
+	if (!std::filesystem::exists(project.outputFile)) {
+		print("Compile project");
+		CompileProject(project);
 
-	print("Built project");
+		print("Built project");
+	}
 
 	print("Init SDL2");
 	initSDL();
@@ -222,6 +338,7 @@ int main(int argc, char *argv[]) {
 	lens.position = vec3(lens.ScreenSize()/2.f, 0);
 
 	s_render.create();
+	s_render.setJobExecutor(&s_job);
 	s_render.setPixelDensity(s_window.getPixelDesity());
 	s_render.setViewport(windowWidth, windowHeight);
 	s_render.setCamera(lens);
@@ -235,6 +352,9 @@ int main(int argc, char *argv[]) {
 	s_app.logger = &s_log;
 	s_app.fontGenerator = &s_fontGenerator;
 	s_app.ui = &s_ui;
+	s_app.profile = &s_profile;
+	s_app.jobs = &s_job;
+	s_app.meshes = &s_meshes;
 
 	s_plugin = SketchPlugin(project);
 	s_plugin.create(&s_app);
@@ -243,6 +363,8 @@ int main(int argc, char *argv[]) {
 		return 1;
 	}
 
+	s_pluginVersion = s_plugin.getVersion();
+
 	Font defaultFont;
 	defaultFont
 		.source("C:/Windows/Fonts/seguisb.ttf")
@@ -255,44 +377,80 @@ int main(int argc, char *argv[]) {
 	lithUpdateTime();
 
 	while (running) {
-		s_window.pollEvents(&s_events);
-		s_input.UpdateStates(lithDeltaTime());
-
-		for (lithEvent& e : s_events.in) {
-			inputEventHandler(e);
+		{
+			LITH_PROFILE_SCOPE("events");
+
+			s_window.pollEvents(&s_windowEvents);
+			s_input.UpdateStates(lithDeltaTime());
+
+			s_windowEvents.consume([](const lithEvent& e) {
+				s_events.in.push(e);
+				inputEventHandler(e);
+
+				switch (e.type) {
+					case lithExit:
+						running = false;
+						break;
+					default:
+						break;
+				}
+			});
 
-			switch (e.type) {
-				case lithExit:
-					running = false;
-					break;
-				default:
-					break;
-			}
+			s_events.in.flush();
 		}
 
 		lithUpdateTime();
 
-		glClearColor(.06, .06, .06, 1);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		{
+			LITH_PROFILE_SCOPE("sketch");
+
+			watchSketch();
+
+			s_plugin.update();
+			s_plugin.handleEventsOut(sketchPluginEventHandler);
+		}
+
+		{
+			LITH_PROFILE_SCOPE("render");
 
-		s_plugin.update();
-		s_plugin.handleEventsOut(sketchPluginEventHandler);
+			// the text cache is only ticked by the clear at the end of the frame,
+			// so text drawn every frame stays cached
+			s_render.draw();
+			s_render.clearBatches();
 
-		const CameraLens& c = s_render.getCamera();
-		vec2 rootPosition = vec2(-c.height / 2 * c.aspect, c.height / 2) + vec2(c.position);
-		float pt = s_render.getCamera().height / s_render.getViewportSize().second;
+			// drawn over the canvas, so they don't stay on it
+			const CameraLens& c = s_render.getCamera();
+			vec2 rootPosition = vec2(-c.height / 2 * c.aspect, c.height / 2) + vec2(c.position);
+			float pt = s_render.getCamera().height / s_render.getViewportSize().second;
 
-		s_render.text(rootPosition, 12 * pt, {TextAlignLeft, TextAlignTop}, defaultFont, s_log.getLines());
+			s_render.text(rootPosition, 12 * pt, {TextAlignLeft, TextAlignTop}, defaultFont, s_log.getLines());
+			s_profilerOverlay.draw(&s_render, defaultFont);
 
-		s_render.draw();
-		s_render.clear();
+			s_render.drawOverlay();
+			s_render.clear();
+		}
+
+		{
+			LITH_PROFILE_SCOPE("swap");
+			s_window.swapBuffers();
+		}
+
+		timeReload();
 
-		s_window.swapBuffers();
 		s_log.removeOldLogs(lithDeltaTime());
+
+		{
+			LITH_PROFILE_SCOPE("wait");
+			lithWaitForFrame();
+		}
+
+		lithProfileFrame();
 	}
 
 	s_plugin.free();
 	s_audio.free();
 
+	lithMeshCacheClear();
+
 	return 0;
 }
\ No newline at end of file
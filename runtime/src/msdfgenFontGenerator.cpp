@@ -3,6 +3,31 @@
 
 #include "lith/log.h"
 
+// Runs the msdf-atlas-gen workloads as jobs instead of on new threads
+class JobWorkloadExecutor : public msdf_atlas::WorkloadExecutor {
+public:
+	JobWorkloadExecutor(JobExecutor* jobs)
+		: m_jobs (jobs)
+	{}
+
+	int threadCount() const override {
+		return m_jobs->ThreadCount() + 1;
+	}
+
+	void execute(const std::function<void()>& task) override {
+		JobTree& tree = m_jobs->CreateTree();
+		tree.Create([task](Job _) { task(); });
+		m_jobs->Run(tree);
+	}
+
+private:
+	JobExecutor* m_jobs;
+};
+
+void msdfgenFontGenerator::setJobExecutor(JobExecutor* jobs) {
+	m_jobs = jobs;
+}
+
 FontGenerationOutput msdfgenFontGenerator::generate(const FontGenerationInput& config) const {
 	FontGenerationOutput output;
 	
@@ -39,6 +64,8 @@ FontGenerationOutput msdfgenFontGenerator::generate(const FontGenerationInput& c
 		return output;
 	}
 
+	JobWorkloadExecutor executor(m_jobs);
+
 	std::vector<msdf_atlas::GlyphGeometry> glyphs;
 
 	msdf_atlas::FontGeometry fontGeometry(&glyphs);
@@ -52,7 +79,16 @@ FontGenerationOutput msdfgenFontGenerator::generate(const FontGenerationInput& c
 			return true;
 		};
 
-		msdf_atlas::Workload(work, glyphs.size()).finish(threadCount);
+		// coloring is linear in the number of edges
+		std::vector<double> costs;
+		for (const msdf_atlas::GlyphGeometry& glyph : glyphs) {
+			costs.push_back(glyph.getShape().edgeCount());
+		}
+
+		msdf_atlas::Workload workload(work, glyphs.size(), costs);
+
+		if (m_jobs) workload.finish(executor);
+		else        workload.finish(threadCount);
 	}
 
 	else {
@@ -75,12 +111,14 @@ FontGenerationOutput msdfgenFontGenerator::generate(const FontGenerationInput& c
 	packer.setMinimumScale(config.generationScale);
 	packer.setPixelRange(2.0);
 	packer.setMiterLimit(1.0);
+	packer.setExecutor(m_jobs ? &executor : nullptr);
 	packer.pack(glyphs.data(), glyphs.size());
 	packer.getDimensions(width, height);        // sets width and height with pass-by-ref
 
 	generator_t generator(width, height);
 	generator.setAttributes(attributes);
 	generator.setThreadCount(threadCount);
+	generator.setExecutor(m_jobs ? &executor : nullptr);
 	generator.generate(glyphs.data(), glyphs.size());
 	
 	bitmap_t bitmap = generator.atlasStorage();
@@ -1,8 +1,16 @@
 #pragma once
 
 #include "lith/font.h"
+#include "lith/job.h"
 
 class msdfgenFontGenerator : public FontGeneratorInterface {
 public:
     FontGenerationOutput generate(const FontGenerationInput& config) const override;
+
+    // Edge coloring and glyph generation run on these threads, and on the calling thread.
+    // If null, they spawn their own threads
+    void setJobExecutor(JobExecutor* jobs);
+
+private:
+    JobExecutor* m_jobs = nullptr;
 };
\ No newline at end of file
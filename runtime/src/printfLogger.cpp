@@ -1,27 +1,138 @@
 #include "printfLogger.h"
+#include <cstdio>
+#include <cstring>
 
 printfLogger::printfLogger()
-	: isStale(false)
-{}
+	: pushed(0)
+	, running(true)
+	, overlayBegin(0)
+	, overlaySize(0)
+	, isStale(false)
+{
+	thread = std::thread([this]() { sink(); });
+}
+
+printfLogger::~printfLogger() {
+	running = false;
+	pushed.fetch_add(1, std::memory_order_release);
+	pushed.notify_one();
+
+	thread.join();
+
+	// a producer which saw running just before it was cleared can push after the sink's
+	// last drain, write those straight out
+	auto read = [](Message& message) {
+		printf("%s\n", message.overflow ? message.overflow : message.text);
+		delete[] message.overflow;
+	};
+
+	while (queue.try_consume(read)) {}
+}
 
 void printfLogger::log(const char* str) {
-	printf("%s\n", str);
-	logs.push_back({ str, 3.f });
-	isStale = true;
+	// the sink has stopped during shutdown
+	if (!running.load(std::memory_order_relaxed)) {
+		printf("%s\n", str);
+		return;
+	}
+
+	size_t length = strlen(str);
+
+	auto write = [&](Message& message) {
+		if (length < messageLength) {
+			memcpy(message.text, str, length + 1);
+			message.overflow = nullptr;
+		}
+
+		else {
+			message.overflow = new char[length + 1];
+			memcpy(message.overflow, str, length + 1);
+		}
+	};
+
+	// when full, wait for the sink instead of dropping the message
+	while (!queue.try_emplace(write)) {
+		std::this_thread::yield();
+	}
+
+	pushed.fetch_add(1, std::memory_order_release);
+	pushed.notify_one();
+}
+
+void printfLogger::sink() {
+	std::string batch;
+	std::string lines[overlayCount];
+
+	while (true) {
+		// read the counter before checking the queue, so a push between
+		// the check and the wait wakes us up
+		uint32_t seen = pushed.load(std::memory_order_acquire);
+
+		int count = 0;
+
+		auto read = [&](Message& message) {
+			const char* text = message.overflow ? message.overflow : message.text;
 
-	if (logs.size() > 50) {
-		logs.erase(logs.begin());
+			batch.append(text);
+			batch.push_back('\n');
+
+			lines[count % overlayCount] = text;
+			count += 1;
+
+			delete[] message.overflow;
+		};
+
+		while (queue.try_consume(read)) {}
+
+		if (count > 0) {
+			fwrite(batch.data(), 1, batch.size(), stdout);
+			fflush(stdout);
+			batch.clear();
+
+			std::scoped_lock lock(overlayMutex);
+
+			// only the last overlayCount lines of the batch survive anyway
+			int first = count > overlayCount ? count - overlayCount : 0;
+			for (int i = first; i < count; i++) {
+				int index;
+
+				if (overlaySize < overlayCount) {
+					index = (overlayBegin + overlaySize) % overlayCount;
+					overlaySize += 1;
+				}
+
+				else {
+					index = overlayBegin;
+					overlayBegin = (overlayBegin + 1) % overlayCount;
+				}
+
+				overlay[index].text.swap(lines[i % overlayCount]);
+				overlay[index].life = overlayLife;
+			}
+
+			isStale = true;
+			continue;
+		}
+
+		if (!running.load(std::memory_order_acquire)) {
+			break;
+		}
+
+		pushed.wait(seen, std::memory_order_acquire);
 	}
 }
 
 const std::string& printfLogger::getLines() {
+	std::scoped_lock lock(overlayMutex);
+
 	if (isStale) {
-		std::stringstream ss;
-		for (const auto& [str, _] : logs) {
-			ss << str << '\n';
+		string.clear();
+
+		for (int i = 0; i < overlaySize; i++) {
+			string.append(overlay[(overlayBegin + i) % overlayCount].text);
+			string.push_back('\n');
 		}
 
-		string = ss.str();
 		isStale = false;
 	}
 
@@ -29,20 +140,24 @@ const std::string& printfLogger::getLines() {
 }
 
 void printfLogger::clear() {
-	logs = {};
+	std::scoped_lock lock(overlayMutex);
+
+	overlayBegin = 0;
+	overlaySize = 0;
 	isStale = true;
 }
 
 void printfLogger::removeOldLogs(float deltaTime) {
-	for (int i = 0; i < logs.size(); i++) {
-		float& life = logs[i].second;
-		life -= deltaTime;
+	std::scoped_lock lock(overlayMutex);
 
-		if (life < 0.f) {
-			logs.erase(logs.begin() + i);
-			i--;
+	for (int i = 0; i < overlaySize; i++) {
+		overlay[(overlayBegin + i) % overlayCount].life -= deltaTime;
+	}
 
-			isStale = true;
-		}
+	// every line gets the same life, so the oldest expire first
+	while (overlaySize > 0 && overlay[overlayBegin].life < 0.f) {
+		overlayBegin = (overlayBegin + 1) % overlayCount;
+		overlaySize -= 1;
+		isStale = true;
 	}
 }
@@ -1,13 +1,20 @@
 #pragma once
 
 #include "lith/log.h"
-#include <sstream>
-#include <vector>
-#include <utility>
+#include "lith/ring.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Logs are pushed into a lock-free queue from any thread, a background
+// thread writes them to stdout in batches and keeps the last few for the overlay.
+// getLines, clear and removeOldLogs should only be called from the main thread.
 
 class printfLogger : public LoggerInterface {
 public:
 	printfLogger();
+	~printfLogger();
 
 	void log(const char* str) override;
 
@@ -17,7 +24,37 @@ public:
 	void removeOldLogs(float deltaTime);
 
 private:
+	void sink();
+
+private:
+	static constexpr int messageLength = 240;
+	static constexpr int overlayCount = 50;
+	static constexpr float overlayLife = 3.f;
+
+	// messages longer than the inline text are allocated, and freed by the sink
+	struct Message {
+		char text[messageLength];
+		char* overflow;
+	};
+
+	mpsc_ring<Message, 4096> queue;
+
+	// bumped on every push, the sink waits on it when the queue is empty
+	std::atomic<uint32_t> pushed;
+	std::atomic<bool> running;
+	std::thread thread;
+
+	struct OverlayLine {
+		std::string text;
+		float life;
+	};
+
+	// circular, shared between the sink and the main thread
+	std::mutex overlayMutex;
+	OverlayLine overlay[overlayCount];
+	int overlayBegin;
+	int overlaySize;
 	bool isStale;
+
 	std::string string;
-	std::vector<std::pair<std::string, float>> logs;
 };